@@ -42,6 +42,9 @@
 
 #include "../audio_driver.h"
 #include "../../verbosity.h"
+#if defined(MIYOOMINI)
+#include "../../miyoomini.h"
+#endif
 
 /* MI_AO_SendFrame Max bytes */
 #define MIAO_MAX_BUFSIZE 51200
@@ -54,8 +57,38 @@ typedef struct miao_audio
    bool nonblock;
    bool is_paused;
    void* nullbuf;
+#if defined(MIYOOMINI)
+   uint32_t resume_seq;
+#endif
 } miao_audio_t;
 
+#if defined(MIYOOMINI)
+/* Deep pause: let queued samples play out, then stop the channel.
+ * On exit the channel is enabled again with pre-fill null data. */
+static void miao_deep_pause(bool paused, void *data)
+{
+   miao_audio_t *miaoaudio = (miao_audio_t*)data;
+   MI_AO_ChnState_t status;
+
+   if (paused) {
+      /* bufsize bytes take at most bufsize/4 samples to play */
+      uint32_t timeout = (miaoaudio->bufsize >> 2) * 1000 / miaoaudio->freq + 10;
+      for (; timeout; timeout--) {
+         MI_AO_QueryChnStat(0, 0, &status);
+         if (!status.u32ChnBusyNum) break;
+         usleep(1000);
+      }
+      MI_AO_DisableChn(0,0);
+   } else {
+      MI_AO_EnableChn(0,0);
+      miaoaudio->AoSendFrame.apVirAddr[0] = miaoaudio->nullbuf;
+      miaoaudio->AoSendFrame.u32Len = miaoaudio->bufsize;
+      MI_AO_ClearChnBuf(0,0);
+      MI_AO_SendFrame(0, 0, &miaoaudio->AoSendFrame, 0);
+   }
+}
+#endif
+
 static void *miao_init(const char *device,
       unsigned rate, unsigned latency,
       unsigned block_frames,
@@ -105,10 +138,17 @@ static void *miao_init(const char *device,
    /* Send pre-fill null data */
    miaoaudio->nullbuf = calloc(1, miaoaudio->bufsize);
    if (!miaoaudio->nullbuf) goto error;
+#if defined(MIYOOMINI)
+   miyoo_prefault(miaoaudio->nullbuf, miaoaudio->bufsize);
+#endif
    miaoaudio->AoSendFrame.apVirAddr[0] = miaoaudio->nullbuf;
    miaoaudio->AoSendFrame.u32Len = miaoaudio->bufsize;
    MI_AO_ClearChnBuf(0,0);
    MI_AO_SendFrame(0, 0, &miaoaudio->AoSendFrame, 0);
+#if defined(MIYOOMINI)
+   miyoo_deep_pause_register(miao_deep_pause, miaoaudio);
+   miaoaudio->resume_seq = miyoo_resume_seq();
+#endif
 
    return miaoaudio;
 
@@ -123,6 +163,17 @@ static ssize_t miao_write(void *data, const void *buf, size_t size)
    miao_audio_t *miaoaudio = (miao_audio_t*)data;
    if ((!size)||(miaoaudio->is_paused)) return 0;
 
+#if defined(MIYOOMINI)
+   /* Resumed from suspend, queue ran dry while stopped: restart from pre-fill */
+   if (miaoaudio->resume_seq != miyoo_resume_seq()) {
+      miaoaudio->resume_seq = miyoo_resume_seq();
+      miaoaudio->AoSendFrame.apVirAddr[0] = miaoaudio->nullbuf;
+      miaoaudio->AoSendFrame.u32Len = miaoaudio->bufsize;
+      MI_AO_ClearChnBuf(0,0);
+      MI_AO_SendFrame(0, 0, &miaoaudio->AoSendFrame, 0);
+   }
+#endif
+
    miaoaudio->AoSendFrame.apVirAddr[0] = (void*)buf;
    ssize_t write_bytes;
    uint32_t usleepclock;
@@ -201,6 +252,9 @@ static void miao_set_nonblock_state(void *data, bool state)
 static void miao_free(void *data)
 {
    miao_audio_t *miaoaudio = (miao_audio_t*)data;
+#if defined(MIYOOMINI)
+   miyoo_deep_pause_unregister(miao_deep_pause);
+#endif
    MI_AO_ClearChnBuf(0,0);
    MI_AO_DisableChn(0,0);
    MI_AO_Disable(0);
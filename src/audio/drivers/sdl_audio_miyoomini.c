@@ -35,6 +35,9 @@
 
 #include "../audio_driver.h"
 #include "../../verbosity.h"
+#if defined(MIYOOMINI)
+#include "../../miyoomini.h"
+#endif
 
 #define SDL_AUDIO_SAMPLES 256
 
@@ -47,6 +50,9 @@ typedef struct sdl_audio
    fifo_buffer_t *buffer;
    bool nonblock;
    bool is_paused;
+#if defined(MIYOOMINI)
+   bool policy_pending;
+#endif
    size_t bufsize;
 } sdl_audio_t;
 
@@ -56,6 +62,13 @@ static void sdl_audio_cb(void *data, Uint8 *stream, int len)
    size_t      avail = FIFO_READ_AVAIL(sdl->buffer);
    size_t write_size = len > (int)avail ? avail : len;
 
+#if defined(MIYOOMINI)
+   /* Apply thread placement policy from the callback thread itself */
+   if (sdl->policy_pending) {
+      sdl->policy_pending = false;
+      miyoo_thread_policy_register(MIYOO_THREAD_AUDIO, pthread_self());
+   }
+#endif
    fifo_read(sdl->buffer, stream, write_size);
 #ifdef HAVE_THREADS
    scond_signal(sdl->cond);
@@ -129,6 +142,10 @@ static void *sdl_audio_init(const char *device,
    tmp = calloc(1, (sdl->bufsize / 2));
    if (tmp) { fifo_write(sdl->buffer, tmp, (sdl->bufsize / 2)); free(tmp); }
 
+#if defined(MIYOOMINI)
+   miyoo_prefault(sdl->buffer->buffer, sdl->bufsize);
+   sdl->policy_pending = true;
+#endif
    SDL_PauseAudio(0);
 
    return sdl;
@@ -220,6 +237,9 @@ static void sdl_audio_free(void *data)
 {
    sdl_audio_t *sdl = (sdl_audio_t*)data;
 
+#if defined(MIYOOMINI)
+   miyoo_thread_policy_unregister(MIYOO_THREAD_AUDIO);
+#endif
    SDL_CloseAudio();
 
    fifo_free(sdl->buffer);
@@ -6,6 +6,7 @@
 #include <linux/fb.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
+#include <time.h>
 #include <SDL/SDL.h>
 #include <mi_sys.h>
 #include <mi_gfx.h>
@@ -22,6 +23,8 @@
 //			:  when NOWAIT, do not clear/write source surface immediately after Flip
 //			:  if absolutely necessary, use GFX_WaitAllDone() before write (or GFX_FlipWait())
 enum { GFX_BLOCKING = 1, GFX_FLIPWAIT = 2 };
+//	VBLANK_USEC	: estimated vblank period of the panel (60Hz), used by the single HW surface flip thread
+#define	VBLANK_USEC	16667
 //#define	DEFAULTFLIPFLAGS	(GFX_BLOCKING | GFX_FLIPWAIT)		// low performance with blocking
 //#define	DEFAULTFLIPFLAGS	(GFX_FLIPWAIT)				// middle performance nonblock, recommended for most cases
 #define	DEFAULTFLIPFLAGS	0					// high performance but with the above precautions
@@ -29,6 +32,8 @@ enum { GFX_BLOCKING = 1, GFX_FLIPWAIT = 2 };
 int			fd_fb = 0;
 void			*fb_addr;
 uint32_t 		res_x, res_y;
+uint32_t		fb_pixsize = 4;	// bytes per pixel of FB (4:ARGB8888 / 2:RGB565)
+struct fb_var_screeninfo vinfo_org;
 struct			fb_fix_screeninfo finfo;
 struct			fb_var_screeninfo vinfo;
 MI_GFX_Surface_t	stSrc;
@@ -43,15 +48,36 @@ pthread_t		flip_pt;
 pthread_mutex_t		flip_mx;
 pthread_cond_t		flip_req;
 pthread_cond_t		flip_start;
+uint32_t		flipRunning;	// flip thread is started
+volatile uint32_t	flipQuit;	// ask flip thread to exit, set with flip_mx locked
 MI_U16			flipFence;
 uint32_t		flipFlags;
+uint32_t		prefaultMode;	// populate FB mapping / touch all surface pages at allocation
 SDL_Surface		*sHWsurface;
 SDL_Surface		*videosurface;
 MI_GFX_Surface_t	sHW;
 MI_GFX_Rect_t		sHWRect;
 MI_GFX_Opt_t		sHWOpt;
+MI_GFX_Rect_t		pageDirty[3];	// bounding rect drawn on each FB page since cleared (u32Width == 0 : clean)
+MI_GFX_Rect_t		sHWDirty[2];	// pending update rect of sHWsurface for each FB page (u32Width == 0 : clean)
+volatile uint32_t	sHWChanged;
+uint32_t		sHWInterval;	// flip rate cap in usec (0 = vblank estimate only)
 void			(*flip_callback)(void*) = NULL;
 void			*userdata_callback = NULL;
+#define			FLIPBLITMAX	256
+MI_GFX_Surface_t	flipBlitSrc[2];	// keyed blits drawn onto every flipped page (OSD text glyphs, etc)
+MI_GFX_Opt_t		flipBlitOpt[2];	// [0] : set by GFX_SetFlipBlits / [1] : used by flip thread
+MI_GFX_Rect_t		flipBlitSrcRect[2][FLIPBLITMAX];
+MI_GFX_Rect_t		flipBlitDstRect[2][FLIPBLITMAX];
+MI_GFX_Rect_t		flipBlitBound[2];
+uint32_t		flipBlitCount[2];
+uint32_t		flipBlitPending;
+MI_GFX_Surface_t	flipLayerSrc[2];	// alpha blended layer drawn onto every flipped page (notifications, etc)
+MI_GFX_Rect_t		flipLayerSrcRect[2];	// [0] : set by GFX_SetFlipLayer / [1] : used by flip thread
+MI_GFX_Rect_t		flipLayerDstRect[2];	// u32Width == 0 : off
+MI_GFX_Opt_t		flipLayerOpt;
+uint32_t		flipLayerPending;
+volatile MI_U16		flipLayerFence;	// fence of the last layer blit issued by flip thread
 #ifdef	HAVE_OVERLAY
 SDL_Surface		*ovrsurface;
 MI_GFX_Surface_t	OvrSrc;
@@ -59,39 +85,152 @@ MI_GFX_Rect_t		OvrSrcRect;
 MI_GFX_Surface_t	OvrDst;
 MI_GFX_Rect_t		OvrDstRect;
 MI_GFX_Opt_t		OvrOpt;
+MI_GFX_Rect_t		OvrBound;	// bounding rect of non transparent pixels of overlay (FB coords)
+MI_GFX_Rect_t		OvrGameRect;	// part of OvrBound over the game rect, blended at every flip
+MI_GFX_Rect_t		OvrCacheRect;	// game rect that OvrGameRect is made for
+uint32_t		ovrScaled;	// overlay is not FB size, always blend entire overlay
+uint32_t		ovrPageCached[3];	// overlay border is composited on FB page
+MI_GFX_Rect_t		ovrBlitRect[3];	// overlay rect to blend at the pending flip of each page
+uint32_t		pageExtra[3];	// flip blits/layer drawn over FB page since last composited
 #endif
 #ifndef	FREEMMA
 #define			MMADBMAX	100
 uint32_t		mma_db[MMADBMAX];
 #endif
 
+//
+//	Flush write cache of needed segments
+//		x and w are not considered since 4K units
+//
+static inline void FlushCacheNeeded(void* pixels, uint32_t pitch, uint32_t y, uint32_t h) {
+	uintptr_t pixptr = (uintptr_t)pixels;
+	uintptr_t startaddress = (pixptr + pitch*y)&(~4095);
+	uint32_t size = ALIGN4K(pixptr + pitch*(y+h)) - startaddress;
+	if (size) MI_SYS_FlushInvCache((void*)startaddress, size);
+}
+
+//
+//	Get monotonic time in usec
+//
+static inline uint64_t GFX_GetTime(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+//
+//	Merge src rect into dst rect (dst->u32Width == 0 : empty)
+//
+static inline void GFX_MergeRect(MI_GFX_Rect_t *dst, const MI_GFX_Rect_t *src) {
+	if (!src->u32Width || !src->u32Height) return;
+	if (!dst->u32Width || !dst->u32Height) { *dst = *src; return; }
+	int32_t x0 = (dst->s32Xpos < src->s32Xpos) ? dst->s32Xpos : src->s32Xpos;
+	int32_t y0 = (dst->s32Ypos < src->s32Ypos) ? dst->s32Ypos : src->s32Ypos;
+	int32_t x1 = dst->s32Xpos + dst->u32Width;
+	int32_t y1 = dst->s32Ypos + dst->u32Height;
+	if (x1 < (int32_t)(src->s32Xpos + src->u32Width)) x1 = src->s32Xpos + src->u32Width;
+	if (y1 < (int32_t)(src->s32Ypos + src->u32Height)) y1 = src->s32Ypos + src->u32Height;
+	dst->s32Xpos = x0; dst->s32Ypos = y0;
+	dst->u32Width = x1 - x0; dst->u32Height = y1 - y0;
+}
+
+//
+//	Notify sHWsurface update / mark rect as dirty for both FB pages and wake flip thread
+//		rect NULL : entire surface
+//
+static void GFX_NotifySingleHW(MI_GFX_Rect_t *rect) {
+	MI_GFX_Rect_t full = { 0, 0, sHW.u32Width, sHW.u32Height };
+	if (!rect) rect = &full;
+	pthread_mutex_lock(&flip_mx);
+	GFX_MergeRect(&sHWDirty[0], rect);
+	GFX_MergeRect(&sHWDirty[1], rect);
+	sHWChanged = 1;
+	pthread_cond_signal(&flip_req);
+	pthread_mutex_unlock(&flip_mx);
+}
+
+//
+//	Take over Flip blits set by GFX_SetFlipBlits and mark them dirty on the target page
+//		call from flip thread with flip_mx locked
+//
+static inline void GFX_FlipBlitUpdate(uint32_t page) {
+	if (flipBlitPending) {
+		flipBlitSrc[1] = flipBlitSrc[0];
+		flipBlitOpt[1] = flipBlitOpt[0];
+		flipBlitCount[1] = flipBlitCount[0];
+		flipBlitBound[1] = flipBlitBound[0];
+		memcpy(flipBlitSrcRect[1], flipBlitSrcRect[0], sizeof(MI_GFX_Rect_t) * flipBlitCount[0]);
+		memcpy(flipBlitDstRect[1], flipBlitDstRect[0], sizeof(MI_GFX_Rect_t) * flipBlitCount[0]);
+		flipBlitPending = 0;
+	}
+	if (flipLayerPending) {
+		flipLayerSrc[1] = flipLayerSrc[0];
+		flipLayerSrcRect[1] = flipLayerSrcRect[0];
+		flipLayerDstRect[1] = flipLayerDstRect[0];
+		flipLayerPending = 0;
+	}
+	if (flipBlitCount[1]) GFX_MergeRect(&pageDirty[page], &flipBlitBound[1]);
+	GFX_MergeRect(&pageDirty[page], &flipLayerDstRect[1]);
+#ifdef	HAVE_OVERLAY
+	if ((flipBlitCount[1])||(flipLayerDstRect[1].u32Width)) pageExtra[page] = 1;
+#endif
+}
+
+//
+//	Issue Flip blits to FB page without waiting, executed in order by HW after the frame
+//
+static inline void GFX_FlipBlitExec(uint32_t target_offset, MI_U16 *Fence) {
+	MI_GFX_Surface_t Dst = stDst;
+	Dst.phyAddr = finfo.smem_start + (res_x*target_offset*fb_pixsize);
+	if (flipLayerDstRect[1].u32Width) {
+		MI_GFX_BitBlit(&flipLayerSrc[1], &flipLayerSrcRect[1], &Dst, &flipLayerDstRect[1], &flipLayerOpt, Fence);
+		flipLayerFence = *Fence;
+	}
+	for (uint32_t i=0; i<flipBlitCount[1]; i++) {
+		MI_GFX_BitBlit(&flipBlitSrc[1], &flipBlitSrcRect[1][i], &Dst, &flipBlitDstRect[1][i], &flipBlitOpt[1], Fence);
+	}
+}
+
 //
 //	Actual Flip thread
 //
 static void* GFX_FlipThread(void* param) {
 	uint32_t	target_offset;
 	MI_U16		Fence;
+#ifdef	HAVE_OVERLAY
+	MI_GFX_Rect_t	OvrRect;
+#endif
 	pthread_mutex_lock(&flip_mx);
 	while(1) {
-		while (!now_flipping) pthread_cond_wait(&flip_req, &flip_mx);
+		while (!now_flipping) {
+			if (flipQuit) { pthread_mutex_unlock(&flip_mx); return 0; }
+			pthread_cond_wait(&flip_req, &flip_mx);
+		}
 		Fence = flipFence;
 		do {	target_offset = vinfo.yoffset + res_y;
 			if ( target_offset == res_y * 3 ) target_offset = 0;
 			vinfo.yoffset = target_offset;
+			GFX_FlipBlitUpdate(target_offset / res_y);
+#ifdef	HAVE_OVERLAY
+			OvrRect = ovrBlitRect[target_offset / res_y];
+#endif
 			pthread_cond_signal(&flip_start);
 			pthread_mutex_unlock(&flip_mx);
 #ifdef	HAVE_OVERLAY
 			if (ovrsurface) {
-				MI_GFX_WaitAllDone(FALSE, flipFence);
-				OvrDst.phyAddr = finfo.smem_start + (res_x*target_offset*4);
-				MI_GFX_BitBlit(&OvrSrc, &OvrSrcRect, &OvrDst, &OvrDstRect, &OvrOpt, &Fence);
-				MI_GFX_WaitAllDone(FALSE, Fence); Fence = 0;
+				// executed in order by HW after the frame, only the rect decided by GFX_FlipExec
+				OvrDst.phyAddr = finfo.smem_start + (res_x*target_offset*fb_pixsize);
+				if (ovrScaled) MI_GFX_BitBlit(&OvrSrc, &OvrSrcRect, &OvrDst, &OvrDstRect, &OvrOpt, &Fence);
+				else if (OvrRect.u32Width) MI_GFX_BitBlit(&OvrSrc, &OvrRect, &OvrDst, &OvrRect, &OvrOpt, &Fence);
+				GFX_FlipBlitExec(target_offset, &Fence);
+				MI_GFX_WaitAllDone(FALSE, Fence ? Fence : flipFence); Fence = 0;
 				if (flip_callback) flip_callback(userdata_callback);
 			} else
 #endif
+			GFX_FlipBlitExec(target_offset, &Fence);
 			if (flip_callback) {
 				// Wait done always when callback is active
-				MI_GFX_WaitAllDone(FALSE, flipFence); Fence = 0;
+				MI_GFX_WaitAllDone(FALSE, Fence ? Fence : flipFence); Fence = 0;
 				flip_callback(userdata_callback);
 			} else if (Fence) { MI_GFX_WaitAllDone(FALSE, Fence); Fence = 0; }
 			ioctl(fd_fb, FBIOPAN_DISPLAY, &vinfo);
@@ -103,37 +242,100 @@ static void* GFX_FlipThread(void* param) {
 
 //
 //	Actual Flip thread ( for single HW surface )
-//		blit from sHWsurface to FB every frame
+//		sleeps until sHWsurface is updated, then blits only the dirty rect of
+//		the back page at the next estimated vblank (or rate cap) and flips
 //
 static void* GFX_FlipThreadSingleHW(void* param) {
 	MI_GFX_Surface_t Src = sHW;
-	MI_GFX_Rect_t SrcRect = sHWRect;
+	MI_GFX_Rect_t SrcRect;
+	MI_GFX_Rect_t FullSrcRect = { 0, 0, sHW.u32Width, sHW.u32Height };
 	MI_GFX_Surface_t Dst = stDst;
-	MI_GFX_Rect_t DstRect = stDstRect;
+	MI_GFX_Rect_t DstRect;
+	MI_GFX_Rect_t FullDstRect = stDstRect;
 	MI_U16 Fence;
-	uint32_t sHWsize4K = ALIGN4K(sHWsurface->pitch * sHWsurface->h);
-	uint32_t target_offset;
+	uint32_t target_offset, page, interval;
+	uint64_t now, next_flip = 0;
+	// partial update is possible only when not scaled
+	uint32_t noscale = (Src.u32Width == FullDstRect.u32Width)&&(Src.u32Height == FullDstRect.u32Height);
 
+	pthread_mutex_lock(&flip_mx);
 	while(1) {
-		MI_SYS_FlushInvCache(sHWsurface->pixels, sHWsize4K);
+		// wait for change notification
+		while (!sHWChanged) {
+			if (flipQuit) { pthread_mutex_unlock(&flip_mx); return 0; }
+			pthread_cond_wait(&flip_req, &flip_mx);
+		}
+
+		// wait for next vblank estimate, more changes may be merged meanwhile
+		now = GFX_GetTime();
+		if (now < next_flip) {
+			pthread_mutex_unlock(&flip_mx);
+			usleep(next_flip - now);
+			pthread_mutex_lock(&flip_mx);
+		}
+		sHWChanged = 0;
 		target_offset = vinfo.yoffset ^ res_y;
-		Dst.phyAddr = finfo.smem_start + (res_x*target_offset*4);
+		page = target_offset ? 1 : 0;
+		SrcRect = sHWDirty[page];
+		memset(&sHWDirty[page], 0, sizeof(MI_GFX_Rect_t));
+		GFX_FlipBlitUpdate(page);
+		pthread_mutex_unlock(&flip_mx);
+
+		// callback / flip blits draw over the page, always redraw entire page
+		if ((!SrcRect.u32Width)||(flip_callback)||(flipBlitCount[1])||(flipLayerDstRect[1].u32Width)||(!noscale)||(stOpt.eRotate != E_MI_GFX_ROTATE_180)) SrcRect = FullSrcRect;
+		if ((SrcRect.u32Width == FullSrcRect.u32Width)&&(SrcRect.u32Height == FullSrcRect.u32Height)) {
+			DstRect = FullDstRect;
+		} else {
+			// for rotate180
+			DstRect.s32Xpos = FullDstRect.s32Xpos + FullDstRect.u32Width - (SrcRect.s32Xpos + SrcRect.u32Width);
+			DstRect.s32Ypos = FullDstRect.s32Ypos + FullDstRect.u32Height - (SrcRect.s32Ypos + SrcRect.u32Height);
+			DstRect.u32Width = SrcRect.u32Width;
+			DstRect.u32Height = SrcRect.u32Height;
+		}
+
+		FlushCacheNeeded(sHWsurface->pixels, sHWsurface->pitch, SrcRect.s32Ypos, SrcRect.u32Height);
+		Dst.phyAddr = finfo.smem_start + (res_x*target_offset*fb_pixsize);
 		MI_GFX_BitBlit(&Src, &SrcRect, &Dst, &DstRect, &stOpt, &Fence);
 #ifdef	HAVE_OVERLAY
 		if (ovrsurface) {
-			MI_GFX_WaitAllDone(FALSE, Fence);
-			OvrDst.phyAddr = finfo.smem_start + (res_x*target_offset*4);
-			MI_GFX_BitBlit(&OvrSrc, &OvrSrcRect, &OvrDst, &OvrDstRect, &OvrOpt, &Fence);
+			MI_GFX_Rect_t OvrRect = DstRect;
+			OvrDst.phyAddr = Dst.phyAddr;
+			if ((OvrSrc.u32Width != res_x)||(OvrSrc.u32Height != res_y)) { OvrRect = OvrSrcRect; DstRect = OvrDstRect; }
+			MI_GFX_BitBlit(&OvrSrc, &OvrRect, &OvrDst, &DstRect, &OvrOpt, &Fence);
 		}
 #endif
-		usleep(0x2000);	// wait about 10ms
+		GFX_FlipBlitExec(target_offset, &Fence);
+		MI_GFX_WaitAllDone(FALSE, Fence);
 		vinfo.yoffset = target_offset;
 		if (flip_callback) flip_callback(userdata_callback);
 		ioctl(fd_fb, FBIOPAN_DISPLAY, &vinfo);
+
+		interval = (sHWInterval > VBLANK_USEC) ? sHWInterval : VBLANK_USEC;
+		next_flip = GFX_GetTime() + interval;
+		pthread_mutex_lock(&flip_mx);
 	}
 	return 0;
 }
 
+//
+//	Start / Stop Flip thread
+//		stop lets the thread finish pending flips and exit with flip_mx unlocked, then joins it
+//		flip_mx / flip_req / flip_start stay valid, they are created by GFX_Init and destroyed by GFX_Quit
+//
+static void GFX_FlipThreadStart(void* (*thread)(void*)) {
+	flipQuit = 0;
+	flipRunning = !pthread_create(&flip_pt, NULL, thread, NULL);
+}
+static void GFX_FlipThreadStop(void) {
+	if (!flipRunning) return;
+	pthread_mutex_lock(&flip_mx);
+	flipQuit = 1;
+	pthread_cond_signal(&flip_req);
+	pthread_mutex_unlock(&flip_mx);
+	pthread_join(flip_pt, NULL);
+	flipRunning = 0;
+}
+
 //
 //	Get GFX_ColorFmt from SDL_Surface
 //
@@ -172,16 +374,92 @@ static inline MI_SYS_PixelFormat_e	SYS_PixelFormat(SDL_Surface *surface) {
 }
 
 //
-//	Flush write cache of needed segments
-//		x and w are not considered since 4K units
+//	Clear border of FB page / QuickFill (pageDirty - rect) without waiting
+//		issued before the blit to the page, executed in order by HW
 //
-static inline void FlushCacheNeeded(void* pixels, uint32_t pitch, uint32_t y, uint32_t h) {
-	uintptr_t pixptr = (uintptr_t)pixels;
-	uintptr_t startaddress = (pixptr + pitch*y)&(~4095);
-	uint32_t size = ALIGN4K(pixptr + pitch*(y+h)) - startaddress;
-	if (size) MI_SYS_FlushInvCache((void*)startaddress, size);
+static void GFX_ClearPageBorder(uint32_t page, MI_GFX_Rect_t *rect) {
+	MI_GFX_Rect_t	*dirty = &pageDirty[page];
+	MI_GFX_Rect_t	fill[4];
+	MI_GFX_Surface_t Dst;
+	MI_U16		Fence;
+	uint32_t	i, n = 0;
+
+	if ((dirty->u32Width)&&(dirty->u32Height)) {
+		int32_t dx0 = dirty->s32Xpos, dx1 = dx0 + dirty->u32Width;
+		int32_t dy0 = dirty->s32Ypos, dy1 = dy0 + dirty->u32Height;
+		int32_t rx0 = rect->s32Xpos, rx1 = rx0 + rect->u32Width;
+		int32_t ry0 = rect->s32Ypos, ry1 = ry0 + rect->u32Height;
+		int32_t my0 = (ry0 > dy0) ? ry0 : dy0;
+		int32_t my1 = (ry1 < dy1) ? ry1 : dy1;
+		// top
+		if (ry0 > dy0) fill[n++] = (MI_GFX_Rect_t){ dx0, dy0, dx1-dx0, ((ry0 < dy1) ? ry0 : dy1)-dy0 };
+		// bottom
+		if (ry1 < dy1) fill[n++] = (MI_GFX_Rect_t){ dx0, my1 > dy0 ? my1 : dy0, dx1-dx0, dy1-(my1 > dy0 ? my1 : dy0) };
+		if (my1 > my0) {
+			// left
+			if (rx0 > dx0) fill[n++] = (MI_GFX_Rect_t){ dx0, my0, ((rx0 < dx1) ? rx0 : dx1)-dx0, my1-my0 };
+			// right
+			if (rx1 < dx1) fill[n++] = (MI_GFX_Rect_t){ (rx1 > dx0) ? rx1 : dx0, my0, dx1-((rx1 > dx0) ? rx1 : dx0), my1-my0 };
+		}
+		if (n) {
+			Dst = stDst;
+			Dst.phyAddr = finfo.smem_start + (res_x*res_y*page*fb_pixsize);
+			for (i=0; i<n; i++) {
+				if ((fill[i].u32Width)&&(fill[i].u32Height)) MI_GFX_QuickFill(&Dst, &fill[i], 0, &Fence);
+			}
+		}
+	}
+	*dirty = *rect;
+}
+
+#ifdef	HAVE_OVERLAY
+//
+//	GFX OverlayBound / Get bounding rect of non transparent pixels of overlay in area
+//		area is clipped to overlay, bound.u32Width = 0 when all transparent
+//
+static void GFX_OverlayBound(SDL_Surface *src, MI_GFX_Rect_t *area, MI_GFX_Rect_t *bound) {
+	int32_t x0 = area->s32Xpos, y0 = area->s32Ypos;
+	int32_t x1 = x0 + area->u32Width, y1 = y0 + area->u32Height;
+	if (x0 < 0) x0 = 0;
+	if (y0 < 0) y0 = 0;
+	if (x1 > src->w) x1 = src->w;
+	if (y1 > src->h) y1 = src->h;
+	memset(bound, 0, sizeof(MI_GFX_Rect_t));
+	if ((x0 >= x1)||(y0 >= y1)) return;
+
+	uint32_t mask = 0, key = 0;
+	if ((src->format->BytesPerPixel == 4)&&(src->flags & SDL_SRCCOLORKEY)) { mask = 0xFFFFFFFF; key = src->format->colorkey; }
+	else if ((src->format->BytesPerPixel == 4)&&(src->flags & SDL_SRCALPHA)) mask = src->format->Amask;
+	if (!mask) { bound->s32Xpos = x0; bound->s32Ypos = y0; bound->u32Width = x1-x0; bound->u32Height = y1-y0; return; }
+
+	int32_t bx0 = x1, by0 = y1, bx1 = x0, by1 = y0;
+	for (int32_t y = y0; y < y1; y++) {
+		uint32_t *line = (uint32_t*)((uint8_t*)src->pixels + src->pitch * y);
+		int32_t l = x0, r = x1;
+		while ((l < r)&&((line[l] & mask) == key)) l++;
+		if (l == r) continue;
+		while ((line[r-1] & mask) == key) r--;
+		if (bx0 > l) bx0 = l;
+		if (bx1 < r) bx1 = r;
+		if (by0 > y) by0 = y;
+		by1 = y + 1;
+	}
+	if (bx0 >= bx1) return;
+	bound->s32Xpos = bx0; bound->s32Ypos = by0; bound->u32Width = bx1-bx0; bound->u32Height = by1-by0;
 }
 
+//
+//	GFX UpdateOverlayCache / Recalc overlay rect over the game, called from GFX_FlipExec
+//		pages composited with the previous game rect must be redrawn entirely
+//
+static void GFX_UpdateOverlayCache(void) {
+	if (!memcmp(&OvrCacheRect, &stDstRect, sizeof(MI_GFX_Rect_t))) return;
+	OvrCacheRect = stDstRect;
+	GFX_OverlayBound(ovrsurface, &OvrCacheRect, &OvrGameRect);
+	memset(ovrPageCached, 0, sizeof(ovrPageCached));
+}
+#endif
+
 //
 //	GFX Flip / in place of SDL_Flip
 //		HW Blit : surface -> FB(backbuffer) with Rotate180/bppConvert/Scaling
@@ -217,7 +495,8 @@ void	GFX_FlipExec(SDL_Surface *surface, uint32_t flags) {
 				stSrc.phyAddr = surface->pixelsPa;
 				FlushCacheNeeded(surface->pixels, surface->pitch, stSrcRect.s32Ypos, stSrcRect.u32Height);
 				MI_GFX_BitBlit(&stSrc, &stSrcRect, &sHW, &sHWRect, &sHWOpt, &Fence);
-			}
+				GFX_NotifySingleHW(&sHWRect);
+			} else GFX_NotifySingleHW(NULL);
 			return;
 		}
 
@@ -244,14 +523,38 @@ void	GFX_FlipExec(SDL_Surface *surface, uint32_t flags) {
 			stSrc.phyAddr = surface->pixelsPa;
 		}
 
+#ifdef	HAVE_OVERLAY
+		if ((ovrsurface)&&(!ovrScaled)) GFX_UpdateOverlayCache();
+#endif
 		pthread_mutex_lock(&flip_mx);
 		if (flags & GFX_BLOCKING) {
 			while (now_flipping == 2) pthread_cond_wait(&flip_start, &flip_mx);
 		}
 		target_offset = vinfo.yoffset + res_y;
 		if ( target_offset == res_y * 3 ) target_offset = 0;
-		stDst.phyAddr = finfo.smem_start + (res_x*target_offset*4);
+		stDst.phyAddr = finfo.smem_start + (res_x*target_offset*fb_pixsize);
+#ifdef	HAVE_OVERLAY
+		uint32_t page = target_offset / res_y;
+		if ((ovrsurface)&&(ovrPageCached[page])&&(!pageExtra[page])&&(!flip_callback)) {
+			// overlay border is kept on the page, blend over the game rect only
+			MI_GFX_Rect_t full = { 0, 0, res_x, res_y };
+			GFX_ClearPageBorder(page, &full);
+			ovrBlitRect[page] = OvrGameRect;
+		} else {
+			GFX_ClearPageBorder(page, &stDstRect);
+			// flip callback / overlay draw outside of stDstRect
+			if (ovrsurface) {
+				GFX_MergeRect(&pageDirty[page], ovrScaled ? &OvrDstRect : &OvrBound);
+				ovrBlitRect[page] = OvrBound;
+			}
+			ovrPageCached[page] = (ovrsurface)&&(!ovrScaled)&&(!flip_callback);
+			pageExtra[page] = 0;
+		}
+#else
+		GFX_ClearPageBorder(target_offset / res_y, &stDstRect);
+#endif
 		MI_GFX_BitBlit(&stSrc, &stSrcRect, &stDst, &stDstRect, &stOpt, &flipFence);
+		if (flip_callback) pageDirty[target_offset / res_y] = (MI_GFX_Rect_t){ 0, 0, res_x, res_y };
 
 		// Request Flip
 		if (!now_flipping) {
@@ -276,6 +579,20 @@ void	GFX_FlipForce(SDL_Surface *surface) { GFX_FlipExec(surface, flipFlags | GFX
 uint32_t	GFX_GetFlipFlags(void) { return flipFlags; }
 void		GFX_SetFlipFlags(uint32_t flags) { flipFlags = flags; }
 
+//
+//	Set Prefault mode / call before GFX_Init
+//		populate FB mapping and touch all pages of surfaces at allocation
+//		to avoid page faults while running
+//
+void		GFX_SetPrefault(uint32_t enable) { prefaultMode = enable; }
+
+//
+//	Set FB depth / call before GFX_Init
+//		bpp = 16 : RGB565 scan-out, halves blit/display bandwidth for 16bpp sources
+//		otherwise ARGB8888 (default)
+//
+void		GFX_SetFrameBufferDepth(uint32_t bpp) { fb_pixsize = (bpp == 16) ? 2 : 4; }
+
 //
 //	Get/Set Flip callback, for use direct draw to framebuffer
 //		(Battery icon, RetroArch OSD text, etc)
@@ -283,9 +600,95 @@ void		GFX_SetFlipFlags(uint32_t flags) { flipFlags = flags; }
 //
 void*	GFX_GetFlipCallback(void) { return (void*)flip_callback; }
 void	GFX_SetFlipCallback(void (*callback)(void*), void *userdata) {
+	uint32_t changed = (callback != flip_callback)||(userdata != userdata_callback);
 	userdata_callback = userdata; flip_callback = callback;
+	// redraw for new contents, and once when cleared to erase what the callback painted
+	if ((sHWsurface)&&((callback)||(changed))) GFX_NotifySingleHW(NULL);
+}
+
+//
+//	Set Flip blits / colorkeyed HW blits from src drawn onto every flipped page
+//		after the frame and overlay, in place of drawing by flip callback
+//		rects are in FB coordinates (rotated 180 degrees)
+//		count = 0 : clear / count is limited to FLIPBLITMAX
+//
+void	GFX_SetFlipBlits(SDL_Surface *src, SDL_Rect *srcrect, SDL_Rect *dstrect, uint32_t count) {
+	if ((!src)||(!src->pixelsPa)) count = 0;
+	if (count > FLIPBLITMAX) count = FLIPBLITMAX;
+	pthread_mutex_lock(&flip_mx);
+	if (count) {
+		MI_GFX_Opt_t *Opt = &flipBlitOpt[0];
+		flipBlitSrc[0].phyAddr = src->pixelsPa;
+		flipBlitSrc[0].u32Width = src->w;
+		flipBlitSrc[0].u32Height = src->h;
+		flipBlitSrc[0].u32Stride = src->pitch;
+		flipBlitSrc[0].eColorFmt = GFX_ColorFmt(src);
+		memset(Opt, 0, sizeof(MI_GFX_Opt_t));
+		if (src->flags & SDL_SRCCOLORKEY) {
+			Opt->stSrcColorKeyInfo.bEnColorKey = TRUE;
+			Opt->stSrcColorKeyInfo.eCKeyFmt = flipBlitSrc[0].eColorFmt;
+			Opt->stSrcColorKeyInfo.eCKeyOp = E_MI_GFX_RGB_OP_EQUAL;
+			Opt->stSrcColorKeyInfo.stCKeyVal.u32ColorStart =
+			Opt->stSrcColorKeyInfo.stCKeyVal.u32ColorEnd = src->format->colorkey;
+		}
+		Opt->eSrcDfbBldOp = E_MI_GFX_DFB_BLD_ONE;
+	}
+	memset(&flipBlitBound[0], 0, sizeof(MI_GFX_Rect_t));
+	for (uint32_t i=0; i<count; i++) {
+		flipBlitSrcRect[0][i] = (MI_GFX_Rect_t){ srcrect[i].x, srcrect[i].y, srcrect[i].w, srcrect[i].h };
+		flipBlitDstRect[0][i] = (MI_GFX_Rect_t){ dstrect[i].x, dstrect[i].y, dstrect[i].w, dstrect[i].h };
+		GFX_MergeRect(&flipBlitBound[0], &flipBlitDstRect[0][i]);
+	}
+	flipBlitCount[0] = count;
+	flipBlitPending = 1;
+	pthread_mutex_unlock(&flip_mx);
+	if (sHWsurface) GFX_NotifySingleHW(NULL);
+}
+
+//
+//	Set Flip layer / ARGB8888 surface alpha blended onto every flipped page
+//		after the frame and overlay, under flip blits (one HW blit per flip)
+//		src is upright, x/y : position on screen, srcrect NULL : entire surface
+//		src NULL : off
+//		*Note* do not write the previous src until GFX_GetFlipLayerPending() returns 0
+//
+void	GFX_SetFlipLayer(SDL_Surface *src, SDL_Rect *srcrect, int x, int y) {
+	pthread_mutex_lock(&flip_mx);
+	if ((src)&&(src->pixelsPa)) {
+		flipLayerSrc[0].phyAddr = src->pixelsPa;
+		flipLayerSrc[0].u32Width = src->w;
+		flipLayerSrc[0].u32Height = src->h;
+		flipLayerSrc[0].u32Stride = src->pitch;
+		flipLayerSrc[0].eColorFmt = GFX_ColorFmt(src);
+		if (srcrect) flipLayerSrcRect[0] = (MI_GFX_Rect_t){ srcrect->x, srcrect->y, srcrect->w, srcrect->h };
+		else flipLayerSrcRect[0] = (MI_GFX_Rect_t){ 0, 0, src->w, src->h };
+		// for rotate180
+		flipLayerDstRect[0].s32Xpos = res_x - x - flipLayerSrcRect[0].u32Width;
+		flipLayerDstRect[0].s32Ypos = res_y - y - flipLayerSrcRect[0].u32Height;
+		flipLayerDstRect[0].u32Width = flipLayerSrcRect[0].u32Width;
+		flipLayerDstRect[0].u32Height = flipLayerSrcRect[0].u32Height;
+	} else memset(&flipLayerDstRect[0], 0, sizeof(MI_GFX_Rect_t));
+	flipLayerPending = 1;
+	pthread_mutex_unlock(&flip_mx);
+	if (sHWsurface) GFX_NotifySingleHW(NULL);
+}
+uint32_t	GFX_GetFlipLayerPending(void) { return flipLayerPending; }
+
+//
+//	Wait until the last flip layer blit is done / only that blit, not the whole GFX queue
+//		once GFX_GetFlipLayerPending() returns 0, the previous src is no longer read after this
+//
+void	GFX_WaitFlipLayerDone(void) {
+	MI_U16 fence = flipLayerFence;
+	if (fence) MI_GFX_WaitAllDone(FALSE, fence);
 }
 
+//
+//	Set Flip rate limit for single HW surface (direct draw mode)
+//		fps = 0 : flip at the estimated vblank only
+//
+void	GFX_SetFlipRateLimit(uint32_t fps) { sHWInterval = fps ? 1000000 / fps : 0; }
+
 #ifdef	FREEMMA
 //
 //	Free all allocated MMAs (except "daemon")
@@ -338,7 +741,9 @@ SDL_Surface*	GFX_CreateRGBSurface(uint32_t flags, int width, int height, int dep
 
 	if (MI_SYS_MMA_Alloc(NULL, ALIGN4K(size), &phyAddr)) {
 		// No MMA left .. create normal SDL surface
-		return SDL_CreateRGBSurface(flags,width,height,depth,Rmask,Gmask,Bmask,Amask);
+		surface = SDL_CreateRGBSurface(flags,width,height,depth,Rmask,Gmask,Bmask,Amask);
+		if ((surface)&&(prefaultMode)) memset(surface->pixels, 0, surface->pitch * surface->h);
+		return surface;
 	}
 #ifndef	FREEMMA
 	uint32_t i;
@@ -369,8 +774,7 @@ void	GFX_FreeSurface(SDL_Surface *surface) {
 
 		// stop flip thread when sHWsurface is freed
 		if (surface == sHWsurface) {
-			pthread_cancel(flip_pt);
-			pthread_join(flip_pt, NULL);
+			GFX_FlipThreadStop();
 			sHWsurface = NULL;
 		}
 
@@ -392,7 +796,29 @@ void	GFX_FreeSurface(SDL_Surface *surface) {
 //
 //	Clear entire FrameBuffer
 //
-void	GFX_ClearFrameBuffer(void) { memset(fb_addr, 0, finfo.smem_len); }
+void	GFX_ClearFrameBuffer(void) {
+	memset(fb_addr, 0, finfo.smem_len); memset(pageDirty, 0, sizeof(pageDirty));
+#ifdef	HAVE_OVERLAY
+	memset(ovrPageCached, 0, sizeof(ovrPageCached));
+#endif
+}
+
+//
+//	Reset flip state after the process was stopped (suspend)
+//		FB may have been drawn / panned by others meanwhile,
+//		redraw entire pages and show our current page again
+//
+void	GFX_ResetFlipState(void) {
+	if (!fd_fb) return;
+	pthread_mutex_lock(&flip_mx);
+	for (uint32_t i=0; i<3; i++) pageDirty[i] = (MI_GFX_Rect_t){ 0, 0, res_x, res_y };
+	memset(sHWDirty, 0, sizeof(sHWDirty));
+#ifdef	HAVE_OVERLAY
+	memset(ovrPageCached, 0, sizeof(ovrPageCached));
+#endif
+	if ((!now_flipping)&&(!sHWChanged)) ioctl(fd_fb, FBIOPAN_DISPLAY, &vinfo);
+	pthread_mutex_unlock(&flip_mx);
+}
 
 //
 //	GFX Init / Prepare for HW Blit to FB, call after SDL_Init
@@ -407,13 +833,25 @@ void	GFX_Init(void) {
 		// screen init
 		SDL_SetVideoMode(res_x, res_y, 32, SDL_SWSURFACE);
 		ioctl(fd_fb, FBIOGET_VSCREENINFO, &vinfo);
+		vinfo_org = vinfo;
 		vinfo.yres_virtual = res_y * 3; vinfo.yoffset = 0;
+		if (fb_pixsize == 2) {
+			// RGB565 scan-out
+			vinfo.bits_per_pixel = 16;
+			vinfo.red.offset = 11; vinfo.red.length = 5;
+			vinfo.green.offset = 5; vinfo.green.length = 6;
+			vinfo.blue.offset = 0; vinfo.blue.length = 5;
+			vinfo.transp.offset = vinfo.transp.length = 0;
+		}
 		/* vinfo.xres = vinfo.xres_virtual = 640; vinfo.yres = 480;
 		vinfo.xoffset = vinfo.yoffset = vinfo.red.msb_right = vinfo.green.msb_right = 
 		vinfo.blue.msb_right = vinfo.transp.msb_right = vinfo.blue.offset = 0;
 		vinfo.red.length = vinfo.green.length = vinfo.blue.length = vinfo.transp.length = vinfo.green.offset = 8;
 		vinfo.red.offset = 16; vinfo.transp.offset = 24; vinfo.bits_per_pixel = 32; */
 		ioctl(fd_fb, FBIOPUT_VSCREENINFO, &vinfo);
+		// fallback to the depth actually set
+		ioctl(fd_fb, FBIOGET_VSCREENINFO, &vinfo);
+		fb_pixsize = (vinfo.bits_per_pixel == 16) ? 2 : 4;
 
 		res_x = vinfo.xres;
 		res_y = vinfo.yres;
@@ -421,7 +859,7 @@ void	GFX_Init(void) {
 		ioctl(fd_fb, FBIOGET_FSCREENINFO, &finfo);
 
 		// map fb memory
-		fb_addr = mmap(0, finfo.smem_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd_fb, 0);
+		fb_addr = mmap(0, finfo.smem_len, PROT_READ | PROT_WRITE, MAP_SHARED | (prefaultMode ? MAP_POPULATE : 0), fd_fb, 0);
 
 		// clear entire FB
 		GFX_ClearFrameBuffer();
@@ -432,10 +870,10 @@ void	GFX_Init(void) {
 #endif
 		// prepare for Flip
 		stDst.phyAddr = finfo.smem_start;
-		stDst.eColorFmt = E_MI_GFX_FMT_ARGB8888;
+		stDst.eColorFmt = (fb_pixsize == 2) ? E_MI_GFX_FMT_RGB565 : E_MI_GFX_FMT_ARGB8888;
 		stDst.u32Width = res_x;
 		stDst.u32Height = res_y;
-		stDst.u32Stride = res_x*4;
+		stDst.u32Stride = res_x*fb_pixsize;
 		stDstRect.s32Xpos = 0;
 		stDstRect.s32Ypos = 0;
 		stDstRect.u32Width = res_x;
@@ -451,13 +889,20 @@ void	GFX_Init(void) {
 		stOpt.eSrcDfbBldOp = E_MI_GFX_DFB_BLD_ONE;
 		stOpt.eRotate = E_MI_GFX_ROTATE_180;
 
-		flip_mx = (pthread_mutex_t)PTHREAD_MUTEX_INITIALIZER;
-		flip_req = (pthread_cond_t)PTHREAD_COND_INITIALIZER;
-		flip_start = (pthread_cond_t)PTHREAD_COND_INITIALIZER;
+		pthread_mutex_init(&flip_mx, NULL);
+		pthread_cond_init(&flip_req, NULL);
+		pthread_cond_init(&flip_start, NULL);
 		now_flipping = shadowPa = shadowsize = flipFence = 0;
+		memset(flipBlitCount, 0, sizeof(flipBlitCount)); flipBlitPending = 0;
+		memset(flipLayerDstRect, 0, sizeof(flipLayerDstRect)); flipLayerPending = 0; flipLayerFence = 0;
+		memset(&flipLayerOpt, 0, sizeof(flipLayerOpt));
+		flipLayerOpt.eSrcDfbBldOp = E_MI_GFX_DFB_BLD_ONE;
+		flipLayerOpt.eDstDfbBldOp = E_MI_GFX_DFB_BLD_INVSRCALPHA;
+		flipLayerOpt.eDFBBlendFlag = E_MI_GFX_DFB_BLEND_SRC_PREMULTIPLY;
+		flipLayerOpt.eRotate = E_MI_GFX_ROTATE_180;
 		sHWsurface = videosurface = NULL;
 		flipFlags = DEFAULTFLIPFLAGS;
-		pthread_create(&flip_pt, NULL, GFX_FlipThread, NULL);
+		GFX_FlipThreadStart(GFX_FlipThread);
 	}
 }
 
@@ -466,8 +911,7 @@ void	GFX_Init(void) {
 //
 void	GFX_Quit(void) {
 	if (fd_fb) {
-		pthread_cancel(flip_pt);
-		pthread_join(flip_pt, NULL);
+		GFX_FlipThreadStop();
 
 		MI_GFX_WaitAllDone(TRUE, 0);
 		if (sHWsurface) { SDL_Surface* sHWpush = sHWsurface; sHWsurface = NULL; GFX_FreeSurface(sHWpush); }
@@ -491,10 +935,18 @@ void	GFX_Quit(void) {
 #else
 		// copy current frame to initial frame
 		ioctl(fd_fb, FBIOGET_VSCREENINFO, &vinfo);
-		if (vinfo.yoffset) MI_SYS_MemcpyPa(finfo.smem_start, finfo.smem_start + (res_x*vinfo.yoffset*4), res_x*res_y*4);
+		// RGB565 frame is not usable after restoring ARGB8888
+		if (fb_pixsize != 4) GFX_ClearFrameBuffer();
+		else if (vinfo.yoffset) MI_SYS_MemcpyPa(finfo.smem_start, finfo.smem_start + (res_x*vinfo.yoffset*4), res_x*res_y*4);
 #endif
 		// reset yoffset
 		vinfo.yoffset = 0;
+		if (fb_pixsize != 4) {
+			// restore ARGB8888
+			vinfo.bits_per_pixel = vinfo_org.bits_per_pixel;
+			vinfo.red = vinfo_org.red; vinfo.green = vinfo_org.green;
+			vinfo.blue = vinfo_org.blue; vinfo.transp = vinfo_org.transp;
+		}
 		ioctl(fd_fb, FBIOPUT_VSCREENINFO, &vinfo);
 
 		// unmap fb memory
@@ -502,12 +954,81 @@ void	GFX_Quit(void) {
 
 		close(fd_fb);
 		fd_fb = 0;
+		pthread_cond_destroy(&flip_start);
+		pthread_cond_destroy(&flip_req);
+		pthread_mutex_destroy(&flip_mx);
 
 		MI_GFX_Close();
 		MI_SYS_Exit();
 	}
 }
 
+//
+//	Set FB resolution / switch display mode while running, call after GFX_Init
+//		reprograms vinfo, remaps FB and rebuilds the blit destination
+//		surfaces created by GFX_SetVideoMode are kept
+//		returns 0 : success / -1 : mode rejected (previous mode is restored)
+//
+int	GFX_SetResolution(uint32_t width, uint32_t height) {
+	if (!fd_fb) return -1;
+	if ((width == res_x)&&(height == res_y)) return 0;
+
+	// stop Flip thread
+	GFX_FlipThreadStop();
+	MI_GFX_WaitAllDone(TRUE, 0);
+	munmap(fb_addr, finfo.smem_len);
+
+	// reprogram FB, fallback to the previous mode if rejected
+	struct fb_var_screeninfo vinfo_prev = vinfo;
+	int ret = 0;
+	vinfo.xres = vinfo.xres_virtual = width;
+	vinfo.yres = height; vinfo.yres_virtual = height * 3;
+	vinfo.xoffset = vinfo.yoffset = 0;
+	if ((ioctl(fd_fb, FBIOPUT_VSCREENINFO, &vinfo))||(ioctl(fd_fb, FBIOGET_VSCREENINFO, &vinfo))||
+	    (vinfo.xres != width)||(vinfo.yres != height)) {
+		vinfo = vinfo_prev; vinfo.yoffset = 0;
+		ioctl(fd_fb, FBIOPUT_VSCREENINFO, &vinfo);
+		ioctl(fd_fb, FBIOGET_VSCREENINFO, &vinfo);
+		ret = -1;
+	}
+	fb_pixsize = (vinfo.bits_per_pixel == 16) ? 2 : 4;
+	res_x = vinfo.xres;
+	res_y = vinfo.yres;
+
+	// remap fb memory
+	ioctl(fd_fb, FBIOGET_FSCREENINFO, &finfo);
+	fb_addr = mmap(0, finfo.smem_len, PROT_READ | PROT_WRITE, MAP_SHARED | (prefaultMode ? MAP_POPULATE : 0), fd_fb, 0);
+	GFX_ClearFrameBuffer();
+
+	// rebuild Flip destination
+	stDst.phyAddr = finfo.smem_start;
+	stDst.eColorFmt = (fb_pixsize == 2) ? E_MI_GFX_FMT_RGB565 : E_MI_GFX_FMT_ARGB8888;
+	stDst.u32Width = res_x;
+	stDst.u32Height = res_y;
+	stDst.u32Stride = res_x*fb_pixsize;
+	stDstRect.s32Xpos = 0;
+	stDstRect.s32Ypos = 0;
+	stDstRect.u32Width = res_x;
+	stDstRect.u32Height = res_y;
+#ifdef	HAVE_OVERLAY
+	OvrDst = stDst;
+	OvrDstRect = stDstRect;
+#endif
+
+	// restart Flip thread
+	now_flipping = flipFence = 0;
+	if (sHWsurface) {
+		memset(sHWDirty, 0, sizeof(sHWDirty));
+		sHWChanged = 0;
+		GFX_FlipThreadStart(GFX_FlipThreadSingleHW);
+	} else GFX_FlipThreadStart(GFX_FlipThread);
+	ioctl(fd_fb, FBIOPAN_DISPLAY, &vinfo);
+	// redraw entire sHWsurface to the new mode
+	if (sHWsurface) GFX_NotifySingleHW(NULL);
+
+	return ret;
+}
+
 //
 //	SetVideomode / in place of SDL_SetVideoMode
 //		if flags == SDL_HWSURFACE & non SDL_DOUBLEBUF, change to direct draw mode
@@ -520,15 +1041,11 @@ SDL_Surface*	GFX_SetVideoMode(int width, int height, int bpp, uint32_t flags) {
 	if (bpp != 16) bpp = 32;
 
 	// reinit Flip thread
-	pthread_cancel(flip_pt);
-	pthread_join(flip_pt, NULL);
+	GFX_FlipThreadStop();
 	MI_GFX_WaitAllDone(TRUE, 0);
 	if (sHWsurface) { SDL_Surface* sHWpush = sHWsurface; sHWsurface = NULL; GFX_FreeSurface(sHWpush); }
 	if (videosurface) { GFX_FreeSurface(videosurface); videosurface = NULL; }
 	if (shadowPa) { MI_SYS_MMA_Free(shadowPa); shadowPa = shadowsize = 0; }
-	flip_mx = (pthread_mutex_t)PTHREAD_MUTEX_INITIALIZER;
-	flip_req = (pthread_cond_t)PTHREAD_COND_INITIALIZER;
-	flip_start = (pthread_cond_t)PTHREAD_COND_INITIALIZER;
 	now_flipping = flipFence = vinfo.yoffset = 0;
 	GFX_ClearFrameBuffer();
 	ioctl(fd_fb, FBIOPAN_DISPLAY, &vinfo);
@@ -548,12 +1065,14 @@ SDL_Surface*	GFX_SetVideoMode(int width, int height, int bpp, uint32_t flags) {
 			sHWRect.u32Height = sHW.u32Height;
 			memset(&sHWOpt, 0, sizeof(sHWOpt));
 			sHWOpt.eSrcDfbBldOp = E_MI_GFX_DFB_BLD_ONE;
-			pthread_create(&flip_pt, NULL, GFX_FlipThreadSingleHW, NULL);
-		} else pthread_create(&flip_pt, NULL, GFX_FlipThread, NULL);
+			memset(sHWDirty, 0, sizeof(sHWDirty));
+			sHWChanged = 0;
+			GFX_FlipThreadStart(GFX_FlipThreadSingleHW);
+		} else GFX_FlipThreadStart(GFX_FlipThread);
 		return sHWsurface;
 	} else {
 		// others
-		pthread_create(&flip_pt, NULL, GFX_FlipThread, NULL);
+		GFX_FlipThreadStart(GFX_FlipThread);
 		videosurface = GFX_CreateRGBSurface(flags, width, height, bpp, 0,0,0,0);
 		return videosurface;
 	}
@@ -669,6 +1188,24 @@ SDL_Surface*	GFX_DuplicateSurface(SDL_Surface *src) {
 		dst = GFX_CreateRGBSurface(0, src->w, src->h, src->format->BitsPerPixel,
 			src->format->Rmask, src->format->Gmask, src->format->Bmask, src->format->Amask);
 		if (dst) GFX_CopySurface(src, dst);
+	} else if (fb_pixsize != 4) {
+		// RGB565 FB, HW blit with rotate180
+		dst = GFX_CreateRGBSurface(0, res_x, res_y, 16, 0,0,0,0);
+		if (dst) {
+			MI_GFX_Surface_t Src = stDst, Dst = stDst;
+			MI_GFX_Rect_t Rect = { 0, 0, res_x, res_y };
+			MI_GFX_Opt_t Opt;
+			MI_U16 Fence;
+			memset(&Opt, 0, sizeof(Opt));
+			Opt.eSrcDfbBldOp = E_MI_GFX_DFB_BLD_ONE;
+			Opt.eRotate = E_MI_GFX_ROTATE_180;
+			MI_GFX_WaitAllDone(TRUE, 0);
+			Src.phyAddr = finfo.smem_start + res_x*vinfo.yoffset*fb_pixsize;
+			Dst.phyAddr = dst->pixelsPa;
+			MI_SYS_FlushInvCache(dst->pixels, ALIGN4K(dst->pitch * dst->h));
+			MI_GFX_BitBlit(&Src, &Rect, &Dst, &Rect, &Opt, &Fence);
+			MI_GFX_WaitAllDone(FALSE, Fence);
+		}
 	} else {
 		dst = GFX_CreateRGBSurface(0, res_x, res_y, 32, 0,0,0,0);
 		if (dst) {
@@ -710,6 +1247,10 @@ void	GFX_UpdateRectExec(SDL_Surface *screen, int x, int y, int w, int h, uint32_
 				sHWRect.u32Height = h;
 				GFX_FlipExec(screen, flags);
 				sHWRect = DstRectPush;
+			} else {
+				// direct draw mode, sHWsurface itself is updated
+				MI_GFX_Rect_t DirtyRect = { x, y, w, h };
+				GFX_NotifySingleHW(&DirtyRect);
 			}
 		} else {
 			GFX_FlipExec(screen, flags);
@@ -1006,8 +1547,12 @@ void GFX_BlitSurfaceMirrorNoWait(SDL_Surface *src, SDL_Rect *srcrect, SDL_Surfac
 #ifdef	HAVE_OVERLAY
 //
 //	GFX SetupOverlaySurface / Setup Overlay Surface (mainly for retroarch)
+//		transparent area of overlay is found here, only the border is composited into each page
+//		once and the part over the game is blended at every flip
 //
 void GFX_SetupOverlaySurface(SDL_Surface *src) {
+	memset(ovrPageCached, 0, sizeof(ovrPageCached));
+	memset(&OvrCacheRect, 0, sizeof(OvrCacheRect));
 	if ((!src)||(!src->pixelsPa)) { ovrsurface = NULL; return; }
 
 	OvrSrc.phyAddr = src->pixelsPa;
@@ -1038,6 +1583,14 @@ void GFX_SetupOverlaySurface(SDL_Surface *src) {
 	}
 	OvrOpt.eSrcDfbBldOp = E_MI_GFX_DFB_BLD_ONE;
 
+	ovrScaled = ((OvrSrc.u32Width != res_x)||(OvrSrc.u32Height != res_y));
+	if (!ovrScaled) {
+		MI_SYS_FlushInvCache(src->pixels, ALIGN4K(src->pitch * src->h));
+		GFX_OverlayBound(src, &OvrSrcRect, &OvrBound);
+		// entire overlay is transparent
+		if (!OvrBound.u32Width) { ovrsurface = NULL; return; }
+	} else OvrBound = OvrDstRect;
+
 	ovrsurface = src;
 	return;
 }
@@ -27,6 +27,7 @@
 #include <gfx/video_frame.h>
 #include <string/stdstring.h>
 #include <encodings/utf.h>
+#include <encodings/crc32.h>
 #include <features/features_cpu.h>
 
 #include "gfx.c"
@@ -34,6 +35,12 @@
 #include <signal.h>
 #include <sys/mman.h>
 #include <sys/time.h>
+#ifdef __ARM_NEON__
+#include <arm_neon.h>
+#endif
+#ifdef HAVE_DYLIB
+#include <dynamic/dylib.h>
+#endif
 
 #ifdef HAVE_CONFIG_H
 #include "../../config.h"
@@ -44,10 +51,12 @@
 #endif
 
 #include "../../dingux/dingux_utils.h"
+#include "../../miyoomini.h"
 
 #include "../../verbosity.h"
 #include "../../gfx/drivers_font_renderer/bitmap.h"
 #include "../../configuration.h"
+#include "../../gfx/video_filters/softfilter_target.h"
 #include "../../file_path_special.h"
 #include "../../paths.h"
 #include "../../retroarch.h"
@@ -65,13 +74,40 @@
 #define OSD_TEXT_LINES_MAX 3	/* 1 .. 7 */
 #define OSD_TEXT_LINE_LEN ((uint32_t)(RGUI_MENU_WIDTH / FONT_WIDTH_STRIDE)-1)
 #define OSD_TEXT_LEN_MAX (OSD_TEXT_LINE_LEN * OSD_TEXT_LINES_MAX)
+#define OSD_GLYPH_WIDTH  ((FONT_WIDTH * 2) + 2)	/* 2x glyph + shadow */
+#define OSD_GLYPH_HEIGHT ((FONT_HEIGHT * 2) + 2)
 #define RGUI_MENU_STRETCH_FILE_PATH "/mnt/SDCARD/.tmp_update/config/RetroArch/.noMenuStretch"
 #define FB_DEVICE_FILE_PATH "/dev/fb0"
 #define NEW_RES_FILE_PATH "/tmp/new_res_available"
+#define NEW_RES_WIDTH  752
+#define NEW_RES_HEIGHT 560
+#define FB_RGB565_FILE_PATH "/mnt/SDCARD/.tmp_update/config/RetroArch/.fbRGB565"
+#define DVFS_FILE_PATH "/mnt/SDCARD/.tmp_update/config/RetroArch/.dvfs"
+#define NOTIFY_FILE_PATH "/mnt/SDCARD/.tmp_update/config/RetroArch/.notifyLayer"
+#define NOTIFY_MARGIN 8
+#define NOTIFY_PADDING 6
+#define NOTIFY_BAR_HEIGHT 6
+#define NOTIFY_BG_COLOUR 0xC0000000
+#define NOTIFY_BAR_BG_COLOUR 0xFF404040
+#define DUP_SAMPLE_STEP 8	/* rows */
+#define DIRECT_RING 3	/* buffers handed to cores, one per FB page */
+#define CAPTURE_THUMB_WIDTH 320	/* savestate thumbnails are captured to fit */
+#define CAPTURE_THUMB_HEIGHT 240
+#define PRESENTER_FILE_PATH "/mnt/SDCARD/.tmp_update/config/RetroArch/.presenter"
 
 uint32_t res_x, res_y;
 bool rgui_menu_stretch = true;
 SDL_Rect rgui_menu_dest_rect;
+#ifdef HAVE_OVERLAY
+/* Overlay image, geometry is normalized top-down */
+typedef struct sdl_miyoomini_overlay_image
+{
+   SDL_Surface *surface;
+   float x, y, w, h;
+   uint8_t alpha;
+} sdl_miyoomini_overlay_image_t;
+#endif
+
 typedef struct sdl_miyoomini_video sdl_miyoomini_video_t;
 struct sdl_miyoomini_video
 {
@@ -92,47 +128,72 @@ struct sdl_miyoomini_video
    bool was_in_menu;
    retro_time_t last_frame_time;
    retro_time_t ff_frame_time_min;
+   retro_time_t ff_iter_time;
+   retro_time_t ff_iter_avg;
+   bool ff_video_off;
    enum dingux_ipu_filter_type filter_type;
    bool vsync;
    bool keep_aspect;
    bool scale_integer;
    bool quitting;
+   bool new_res_available;
    bitmapfont_lut_t *osd_font;
    uint32_t font_colour32;
-   SDL_Surface *menuscreen;
+   uint16_t font_colour16;
    SDL_Surface *menuscreen_rgui;
+   SDL_Surface *capture;
+   unsigned capture_width;     /* size of the last viewport_info, read_viewport fills it */
+   unsigned capture_height;
+   SDL_Surface *direct[DIRECT_RING];
+   uint32_t direct_idx;
+   bool direct_ok;
+   bool scaler_degraded;
+   /* softfilter renders into the direct buffers */
+   struct softfilter_output_target filter_target;
+   softfilter_set_output_target_t filter_set;
+   SDL_Surface *shown;
+   const void *dup_frame;
+   uint32_t dup_sampled;
+   uint32_t dup_rest;
+   uint32_t dup_count;
+   uint32_t dup_total;
+   retro_time_t dup_frame_time;
+   retro_time_t menu_frame_time;
+   bool menu_dirty;
+   bool menu_osd;
 #ifdef HAVE_OVERLAY
    SDL_Surface *overlay_surface;
+   sdl_miyoomini_overlay_image_t *overlay_images;
+   unsigned overlay_count;
+   bool overlay_enabled;
+   bool overlay_dirty;
 #endif
-   unsigned msg_count;
    char msg_tmp[OSD_TEXT_LEN_MAX];
+   SDL_Surface *osd_atlas;
+   SDL_Rect osd_src[OSD_TEXT_LEN_MAX];
+   SDL_Rect osd_dst[OSD_TEXT_LEN_MAX];
+   bool osd_shown;
+   SDL_Surface *notify[2];
+   uint32_t notify_back;
+   /* presenter thread, scales and flips frames handed over by the emulation thread */
+   bool presenter;
+   pthread_t present_pt;
+   pthread_mutex_t present_mx;
+   pthread_cond_t present_cv;
+   bool present_quit;
+   bool present_pending;
+   bool present_busy;
+   const void *present_cur;
+   struct sdl_miyoomini_present_job {
+      const void *frame;
+      unsigned width, height, pitch;
+      bool skip_ok;
+   } present_job;
+   uint32_t present_drops;
+   uint32_t resume_seq;
 };
 
-/* Clear OSD text area, without video_rect, rotate180 */
-static void sdl_miyoomini_clear_msgarea(void* buf, unsigned x, unsigned y, unsigned w, unsigned h, unsigned lines) {
-   if ( ( x == 0 ) && ( w == res_x  ) && ( y == 0 ) && ( h == res_y ) ) return;
-
-   uint32_t x0 = res_x - (x + w); /* left margin , right margin = x */
-   uint32_t y0 = res_y - (y + h); /* top margin , bottom margin = y */
-   uint32_t sl = x0 * sizeof(uint32_t); /* left buffer size */
-   uint32_t sr = x * sizeof(uint32_t); /* right buffer size */
-   uint32_t sw = w * sizeof(uint32_t); /* pitch */
-   uint32_t ss = res_x * sizeof(uint32_t); /* stride */
-   uint32_t vy = OSD_TEXT_Y_MARGIN + 2; /* clear start y offset */
-   uint32_t vh = FONT_HEIGHT_STRIDE * 2 * lines - 2; /* clear height */
-   uint32_t vh1 = (y0 < vy) ? 0 : (y0 - vy); if (vh1 > vh) vh1 = vh;
-   uint32_t vh2 = vh - vh1;
-   uint32_t ssl = ss * vh1 + sl;
-   uint32_t srl = sr + sl;
-   void* ofs = buf + vy * ss;
-
-   if (ssl) memset(ofs, 0, ssl);
-   ofs += ssl + sw;
-   for (; vh2>1; vh2--, ofs += ss) { if (srl) memset(ofs, 0, srl); }
-   if ((vh2) && (sr)) memset(ofs, 0, sr);
-}
-
-/* Print OSD text, flip callback, direct draw to framebuffer, 32bpp, 2x, rotate180 */
+/* Print OSD text, flip callback, direct draw to framebuffer, 32/16bpp, 2x, rotate180 */
 static void sdl_miyoomini_print_msg(void* data) {
    if (unlikely(!data)) return;
    sdl_miyoomini_video_t *vid = (sdl_miyoomini_video_t*)data;
@@ -141,7 +202,7 @@ static void sdl_miyoomini_print_msg(void* data) {
    const char *str  = vid->msg_tmp;
    uint32_t str_len = strlen_size(str, OSD_TEXT_LEN_MAX);
    if (str_len) {
-      screen_buf              = fb_addr + (vinfo.yoffset * res_x * sizeof(uint32_t));
+      screen_buf              = fb_addr + (vinfo.yoffset * res_x * fb_pixsize);
       bool **font_lut         = vid->osd_font->lut;
       uint32_t str_lines      = (uint32_t)((str_len - 1) / OSD_TEXT_LINE_LEN) + 1;
       uint32_t str_counter    = OSD_TEXT_LINE_LEN;
@@ -178,7 +239,34 @@ static void sdl_miyoomini_print_msg(void* data) {
                uint32_t buff_offset = ((y_pos - (j * 2) ) * res_x) + x_pos;
 
                for (i = 0; i < FONT_WIDTH; i++) {
-                  if (*(symbol_lut + i + (j * FONT_WIDTH))) {
+                  if (!*(symbol_lut + i + (j * FONT_WIDTH))) continue;
+                  if (fb_pixsize == 2) {
+                     uint16_t *screen_buf_ptr = (uint16_t*)screen_buf + buff_offset - (i * 2);
+
+                     /* Bottom shadow (1) */
+                     screen_buf_ptr[+0] = 0;
+                     screen_buf_ptr[+1] = 0;
+                     screen_buf_ptr[+2] = 0;
+                     screen_buf_ptr[+3] = 0;
+
+                     /* Bottom shadow (2) */
+                     screen_buf_ptr[res_x+0] = 0;
+                     screen_buf_ptr[res_x+1] = 0;
+                     screen_buf_ptr[res_x+2] = 0;
+                     screen_buf_ptr[res_x+3] = 0;
+
+                     /* Text pixel + right shadow (1) */
+                     screen_buf_ptr[(res_x*2)+0] = 0;
+                     screen_buf_ptr[(res_x*2)+1] = 0;
+                     screen_buf_ptr[(res_x*2)+2] = vid->font_colour16;
+                     screen_buf_ptr[(res_x*2)+3] = vid->font_colour16;
+
+                     /* Text pixel + right shadow (2) */
+                     screen_buf_ptr[(res_x*3)+0] = 0;
+                     screen_buf_ptr[(res_x*3)+1] = 0;
+                     screen_buf_ptr[(res_x*3)+2] = vid->font_colour16;
+                     screen_buf_ptr[(res_x*3)+3] = vid->font_colour16;
+                  } else {
                      uint32_t *screen_buf_ptr = (uint32_t*)screen_buf + buff_offset - (i * 2);
 
                      /* Bottom shadow (1) */
@@ -210,16 +298,226 @@ static void sdl_miyoomini_print_msg(void* data) {
          }
          x_pos -= FONT_WIDTH_STRIDE * 2;
       }
-      vid->msg_count |= (str_lines << 6);
    }
-   if (vid->msg_count & 7) {
-      /* clear recent OSD text */
-      screen_buf = fb_addr;
-      uint32_t target_offset = vinfo.yoffset + res_y;
-      if (target_offset != res_y * 3) screen_buf += target_offset * res_x * sizeof(uint32_t);
-      sdl_miyoomini_clear_msgarea(screen_buf, vid->video_x, vid->video_y, vid->video_w, vid->video_h, vid->msg_count & 7);
+   /* recent OSD text is cleared by GFX_Flip with the border of each page */
+}
+
+/* Put a pixel to the OSD glyph atlas, same depth as framebuffer */
+static inline void sdl_miyoomini_atlas_put(SDL_Surface *atlas, uint32_t x, uint32_t y, uint32_t colour) {
+   uint8_t *line = (uint8_t*)atlas->pixels + (y * atlas->pitch);
+   if (fb_pixsize == 2) ((uint16_t*)line)[x] = colour;
+   else ((uint32_t*)line)[x] = colour;
+}
+
+/* Build OSD glyph atlas, 16x16 cells of glyphs pre-rendered exactly as
+ * sdl_miyoomini_print_msg draws them (2x, shadow, rotate180).
+ * Background is the colour key, so OSD text becomes a list of keyed HW blits.
+ * Falls back to print_msg when no MMA is left */
+static void sdl_miyoomini_init_osd_atlas(sdl_miyoomini_video_t *vid) {
+   SDL_Surface *atlas = GFX_CreateRGBSurface(0, OSD_GLYPH_WIDTH * 16, OSD_GLYPH_HEIGHT * 16,
+         fb_pixsize * 8, 0, 0, 0, 0);
+   if (unlikely(!atlas || !atlas->pixelsPa)) {
+      if (atlas) GFX_FreeSurface(atlas);
+      RARCH_WARN("[MI_GFX]: Failed to init OSD glyph atlas\n");
+      return;
+   }
+
+   uint32_t colour = (fb_pixsize == 2) ? vid->font_colour16 : vid->font_colour32;
+   uint32_t key    = (fb_pixsize == 2) ? ((colour != 0xF81F) ? 0xF81F : 0x07E0) :
+                                         ((colour != 0xFF00FF) ? 0xFF00FF : 0x00FF00);
+   uint32_t x, y, i, j, symbol;
+
+   for (y = 0; y < atlas->h; y++)
+      for (x = 0; x < atlas->w; x++) sdl_miyoomini_atlas_put(atlas, x, y, key);
+
+   for (symbol = 0; symbol < SDL_NUM_FONT_GLYPHS; symbol++) {
+      bool *symbol_lut = vid->osd_font->lut[symbol];
+      uint32_t x0      = (symbol & 15) * OSD_GLYPH_WIDTH;
+      uint32_t y0      = (symbol >> 4) * OSD_GLYPH_HEIGHT;
+
+      for (j = 0; j < FONT_HEIGHT; j++) {
+         y = y0 + ((FONT_HEIGHT - 1 - j) * 2);
+         for (i = 0; i < FONT_WIDTH; i++) {
+            if (!*(symbol_lut + i + (j * FONT_WIDTH))) continue;
+            x = x0 + ((FONT_WIDTH - 1 - i) * 2);
+
+            /* Bottom shadow (1), (2) */
+            for (uint32_t k = 0; k < 4; k++) {
+               sdl_miyoomini_atlas_put(atlas, x + k, y + 0, 0);
+               sdl_miyoomini_atlas_put(atlas, x + k, y + 1, 0);
+            }
+            /* Text pixel + right shadow (1), (2) */
+            for (uint32_t k = 2; k < 4; k++) {
+               sdl_miyoomini_atlas_put(atlas, x + 0, y + k, 0);
+               sdl_miyoomini_atlas_put(atlas, x + 1, y + k, 0);
+               sdl_miyoomini_atlas_put(atlas, x + 2, y + k, colour);
+               sdl_miyoomini_atlas_put(atlas, x + 3, y + k, colour);
+            }
+         }
+      }
+   }
+   MI_SYS_FlushInvCache(atlas->pixels, ALIGN4K(atlas->pitch * atlas->h));
+   SDL_SetColorKey(atlas, SDL_SRCCOLORKEY, key);
+   vid->osd_atlas = atlas;
+}
+
+/* Create notification layer surfaces (double buffered), sized for the current resolution */
+static void sdl_miyoomini_init_notify(sdl_miyoomini_video_t *vid) {
+   for (int i = 0; i < 2; i++) {
+      if (vid->notify[i]) { GFX_FreeSurface(vid->notify[i]); vid->notify[i] = NULL; }
+      vid->notify[i] = GFX_CreateRGBSurface(0, res_x - (NOTIFY_MARGIN * 2),
+            (OSD_TEXT_LINES_MAX * FONT_HEIGHT_STRIDE * 2) + NOTIFY_BAR_HEIGHT + (NOTIFY_PADDING * 3), 32,
+            0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
+   }
+   if (!vid->notify[0] || !vid->notify[1] || !vid->notify[0]->pixelsPa || !vid->notify[1]->pixelsPa) {
+      RARCH_WARN("[MI_GFX]: Failed to init notification layer\n");
+      for (int i = 0; i < 2; i++) {
+         if (vid->notify[i]) { GFX_FreeSurface(vid->notify[i]); vid->notify[i] = NULL; }
+      }
    }
-   vid->msg_count >>= 3;
+   vid->notify_back = 0;
+}
+
+static inline void sdl_miyoomini_notify_fill(SDL_Surface *surface, int x, int y, int w, int h, uint32_t colour) {
+   for (int j = y; j < y + h; j++) {
+      uint32_t *line = (uint32_t*)((uint8_t*)surface->pixels + (j * surface->pitch)) + x;
+      for (int i = 0; i < w; i++) line[i] = colour;
+   }
+}
+
+/* Draw notification to the back layer surface and show it.
+ * CPU draws only when the text changes, the layer is blended by one HW blit per flip.
+ * A trailing "NN%" in the text is also shown as a progress bar */
+static void sdl_miyoomini_notify(sdl_miyoomini_video_t *vid, const char *msg) {
+   if (vid->osd_shown && !strncmp(vid->msg_tmp, msg, sizeof(vid->msg_tmp))) return;
+   /* Back surface may be still in use until the flip thread takes over the last one,
+    * retry at next frame */
+   if (GFX_GetFlipLayerPending()) return;
+   /* only the last layer blit may still read it, the rest of the GFX queue is left running */
+   GFX_WaitFlipLayerDone();
+
+   SDL_Surface *layer     = vid->notify[vid->notify_back];
+   const uint32_t stride  = FONT_WIDTH_STRIDE * 2;
+   const uint32_t line_h  = FONT_HEIGHT_STRIDE * 2;
+   const uint32_t colour  = 0xFF000000 | vid->font_colour32;
+   uint32_t line_len      = (layer->w - (NOTIFY_PADDING * 2)) / stride;
+   uint32_t lines = 1, col = 0, cols_max = 0;
+   int progress           = -1;
+   const char *str;
+
+   memcpy(vid->msg_tmp, msg, sizeof(vid->msg_tmp));
+
+   /* Measure */
+   str = vid->msg_tmp;
+   for (uint32_t len = strlen_size(str, OSD_TEXT_LEN_MAX); len > 0 && *str; len--) {
+      if (col == line_len) {
+         if (lines == OSD_TEXT_LINES_MAX) break;
+         lines++; col = 0;
+      }
+      utf8_walk(&str);
+      if (++col > cols_max) cols_max = col;
+   }
+   /* Progress, "NN%" at the end */
+   str = vid->msg_tmp + strlen_size(vid->msg_tmp, OSD_TEXT_LEN_MAX);
+   while (str > vid->msg_tmp && str[-1] == ' ') str--;
+   if (str > vid->msg_tmp && str[-1] == '%') {
+      const char *num = --str;
+      int value = 0, scale = 1;
+      while (num > vid->msg_tmp && num[-1] >= '0' && num[-1] <= '9' && scale <= 100) {
+         num--; value += (*num - '0') * scale; scale *= 10;
+      }
+      if (num != str && value <= 100) progress = value;
+   }
+
+   SDL_Rect box = { 0, 0, (cols_max * stride) + (NOTIFY_PADDING * 2) - 2, (lines * line_h) + (NOTIFY_PADDING * 2) - 2 };
+   if (progress >= 0) {
+      box.h += NOTIFY_BAR_HEIGHT + NOTIFY_PADDING;
+      box.w  = layer->w;
+   }
+   sdl_miyoomini_notify_fill(layer, 0, 0, box.w, box.h, NOTIFY_BG_COLOUR);
+
+   /* Text, 2x with shadow, shadow first so that text pixels are always on top */
+   for (int pass = 0; pass < 2; pass++) {
+      uint32_t x = NOTIFY_PADDING, y = NOTIFY_PADDING, line = 1;
+      col = 0;
+      str = vid->msg_tmp;
+      for (uint32_t len = strlen_size(str, OSD_TEXT_LEN_MAX); len > 0 && *str; len--) {
+         if (col == line_len) {
+            if (line == lines) break;
+            line++; col = 0; x = NOTIFY_PADDING; y += line_h;
+         }
+         uint32_t symbol = utf8_walk(&str);
+         if (symbol == 339) /* Latin small ligature oe */
+            symbol = 156;
+         if (symbol == 338) /* Latin capital ligature oe */
+            symbol = 140;
+         if ((symbol != ' ') && (symbol < SDL_NUM_FONT_GLYPHS)) {
+            bool *symbol_lut = vid->osd_font->lut[symbol];
+            for (uint32_t j = 0; j < FONT_HEIGHT; j++) {
+               for (uint32_t i = 0; i < FONT_WIDTH; i++) {
+                  if (!*(symbol_lut + i + (j * FONT_WIDTH))) continue;
+                  if (pass) sdl_miyoomini_notify_fill(layer, x + (i * 2), y + (j * 2), 2, 2, colour);
+                  else {
+                     sdl_miyoomini_notify_fill(layer, x + (i * 2), y + (j * 2) + 2, 4, 2, 0xFF000000);
+                     sdl_miyoomini_notify_fill(layer, x + (i * 2) + 2, y + (j * 2), 2, 2, 0xFF000000);
+                  }
+               }
+            }
+         }
+         x += stride; col++;
+      }
+   }
+
+   if (progress >= 0) {
+      int bar_y = box.h - NOTIFY_PADDING - NOTIFY_BAR_HEIGHT;
+      int bar_w = box.w - (NOTIFY_PADDING * 2);
+      sdl_miyoomini_notify_fill(layer, NOTIFY_PADDING, bar_y, bar_w, NOTIFY_BAR_HEIGHT, NOTIFY_BAR_BG_COLOUR);
+      sdl_miyoomini_notify_fill(layer, NOTIFY_PADDING, bar_y, (bar_w * progress) / 100, NOTIFY_BAR_HEIGHT, colour);
+   }
+
+   /* Bottom left, as OSD text */
+   GFX_SetFlipLayer(layer, &box, NOTIFY_MARGIN, res_y - NOTIFY_MARGIN - box.h);
+   vid->notify_back ^= 1;
+   vid->osd_shown    = true;
+}
+
+/* Compose OSD text as glyph blits from the atlas, same layout as print_msg */
+static uint32_t sdl_miyoomini_layout_msg(sdl_miyoomini_video_t *vid) {
+   const char *str  = vid->msg_tmp;
+   uint32_t str_len = strlen_size(str, OSD_TEXT_LEN_MAX);
+   uint32_t count   = 0;
+   if (!str_len) return 0;
+
+   uint32_t str_lines      = (uint32_t)((str_len - 1) / OSD_TEXT_LINE_LEN) + 1;
+   uint32_t str_counter    = OSD_TEXT_LINE_LEN;
+   const int x_pos_def     = res_x - (FONT_WIDTH_STRIDE * 2);
+   int x_pos               = x_pos_def;
+   int y_pos               = OSD_TEXT_Y_MARGIN - 4 + (FONT_HEIGHT_STRIDE * 2 * str_lines);
+
+   for (; str_len > 0; str_len--) {
+      if (!str_counter--) {
+         x_pos = x_pos_def; y_pos -= (FONT_HEIGHT_STRIDE * 2); str_counter = OSD_TEXT_LINE_LEN;
+      }
+      if (*str == ' ') str++;
+      else {
+         uint32_t symbol = utf8_walk(&str);
+
+         if (symbol == 339) /* Latin small ligature oe */
+            symbol = 156;
+         if (symbol == 338) /* Latin capital ligature oe */
+            symbol = 140;
+
+         if (symbol >= SDL_NUM_FONT_GLYPHS) continue;
+
+         vid->osd_src[count] = (SDL_Rect){ (symbol & 15) * OSD_GLYPH_WIDTH, (symbol >> 4) * OSD_GLYPH_HEIGHT,
+               OSD_GLYPH_WIDTH, OSD_GLYPH_HEIGHT };
+         vid->osd_dst[count] = (SDL_Rect){ x_pos - ((FONT_WIDTH - 1) * 2), y_pos - ((FONT_HEIGHT - 1) * 2),
+               OSD_GLYPH_WIDTH, OSD_GLYPH_HEIGHT };
+         count++;
+      }
+      x_pos -= FONT_WIDTH_STRIDE * 2;
+   }
+   return count;
 }
 
 /* Nearest neighbor scalers */
@@ -414,58 +712,27 @@ void scalenn_32(void* data, void* __restrict src, void* __restrict dst, uint32_t
    }
 }
 
-/* Clear border x3 screens for framebuffer (rotate180) */
-static void sdl_miyoomini_clear_border(void* buf, unsigned x, unsigned y, unsigned w, unsigned h) {
-   if ( (x == 0) && (y == 0) && (w == res_x) && (h == res_y) ) return;
-   if ( (w == 0) || (h == 0) ) { memset(buf, 0, res_x * res_y * sizeof(uint32_t) * 3); return; }
-
-   uint32_t x0 = res_x - (x + w); /* left margin , right margin = x */
-   uint32_t y0 = res_y - (y + h); /* top margin , bottom margin = y */
-   uint32_t sl = x0 * sizeof(uint32_t); /* left buffer size */
-   uint32_t sr = x * sizeof(uint32_t); /* right buffer size */
-   uint32_t st = y0 * res_x * sizeof(uint32_t); /* top buffer size */
-   uint32_t sb = y * res_x * sizeof(uint32_t); /* bottom buffer size */
-   uint32_t srl = sr + sl;
-   uint32_t stl = st + sl;
-   uint32_t srb = sr + sb;
-   uint32_t srbtl = srl + sb + st;
-   uint32_t sw = w * sizeof(uint32_t); /* pitch */
-   uint32_t ss = res_x * sizeof(uint32_t); /* stride */
-   uint32_t i;
+/* Get core config path for cpuclock<ext> */
+static bool __get_cpuclock_path(char *path, const char *ext)
+{
+   char config_directory[PATH_MAX_LENGTH];
+   rarch_system_info_t *system = &runloop_state_get_ptr()->system;
+   const char *core_name = system ? system->info.library_name : NULL;
 
-   if (stl) memset(buf, 0, stl); /* 1st top + 1st left */
-   buf += stl + sw;
-   for (i=h-1; i>0; i--, buf += ss) {
-      if (srl) memset(buf, 0, srl); /* right + left */
-   }
-   if (srbtl) memset(buf, 0, srbtl); /* last right + bottom + top + 1st left */
-   buf += srbtl + sw;
-   for (i=h-1; i>0; i--, buf += ss) {
-      if (srl) memset(buf, 0, srl); /* right + left */
-   }
-   if (srbtl) memset(buf, 0, srbtl); /* last right + bottom + top + 1st left */
-   buf += srbtl + sw;
-   for (i=h-1; i>0; i--, buf += ss) {
-      if (srl) memset(buf, 0, srl); /* right + left */
-   }
-   if (srb) memset(buf, 0, srb); /* last right + last bottom */
+   if (string_is_empty(core_name)) return false;
+
+   /* Get base config directory */
+   fill_pathname_application_special(config_directory, sizeof(config_directory), APPLICATION_SPECIAL_DIRECTORY_CONFIG);
+   fill_pathname_join_special_ext(path, config_directory, core_name, "cpuclock", ext, PATH_MAX_LENGTH);
+   return true;
 }
 
 static FILE *__get_cpuclock_file(void)
 {
    FILE *fp = NULL;
-   char config_directory[PATH_MAX_LENGTH];
    char cpuclock_config_path[PATH_MAX_LENGTH];
-   rarch_system_info_t *system = &runloop_state_get_ptr()->system;
-   const char *core_name = system ? system->info.library_name : NULL;
-
-   if (!string_is_empty(core_name)) {
-      /* Get base config directory */
-      fill_pathname_application_special(config_directory, sizeof(config_directory), APPLICATION_SPECIAL_DIRECTORY_CONFIG);
-
-      // Get core config path for cpuclock.txt
-      fill_pathname_join_special_ext(cpuclock_config_path, config_directory, core_name, "cpuclock", ".txt", PATH_MAX_LENGTH);
 
+   if (__get_cpuclock_path(cpuclock_config_path, ".txt")) {
       fp = fopen(cpuclock_config_path, "r");
       RARCH_LOG("[CPU]: Path %s: %s\n", fp ? "found" : "not found", cpuclock_config_path);
    }
@@ -482,10 +749,18 @@ static FILE *__get_cpuclock_file(void)
 #define	BASE_REG_RIU_PA		(0x1F000000)
 #define	BASE_REG_MPLL_PA	(BASE_REG_RIU_PA + 0x103000*2)
 #define	PLL_SIZE		(0x1000)
+static volatile uint16_t* pll_map = NULL;
 static void set_cpuclock(int clock) {
-	sync();
-	int fd_mem = open("/dev/mem", O_RDWR);
-	void* pll_map = mmap(0, PLL_SIZE, PROT_READ|PROT_WRITE, MAP_SHARED, fd_mem, BASE_REG_MPLL_PA);
+	if (!pll_map) {
+		/* map PLL registers once and keep it, sync only before the first change */
+		sync();
+		int fd_mem = open("/dev/mem", O_RDWR);
+		if (fd_mem < 0) return;
+		void* map = mmap(0, PLL_SIZE, PROT_READ|PROT_WRITE, MAP_SHARED, fd_mem, BASE_REG_MPLL_PA);
+		close(fd_mem);
+		if (map == MAP_FAILED) return;
+		pll_map = (volatile uint16_t*)map;
+	}
 
 	uint32_t post_div;
 	if (clock >= 800000) post_div = 2;
@@ -496,7 +771,7 @@ static void set_cpuclock(int clock) {
 	static const uint64_t divsrc = 432000000llu * 524288;
 	uint32_t rate = (clock * 1000)/16 * post_div / 2;
 	uint32_t lpf = (uint32_t)(divsrc / rate);
-	volatile uint16_t* p16 = (uint16_t*)pll_map;
+	volatile uint16_t* p16 = pll_map;
 
 	uint32_t cur_post_div = (p16[0x232] & 0x0F) + 1;
 	uint32_t tmp_post_div = cur_post_div;
@@ -524,21 +799,237 @@ static void set_cpuclock(int clock) {
 			p16[0x232] = (p16[0x232] & 0xF0) | ((tmp_post_div-1) & 0x0F);
 		}
 	}
+}
+
+/* Closed-loop DVFS
+ * Steps the MPLL between DVFS_CLOCK_MIN and the cpuclock.txt clock (ceiling)
+ * by the CPU time per frame against the frame budget, the busier of the
+ * emulation thread (core + present) and the presenter thread when it runs */
+#define DVFS_CLOCK_MIN     400000 /* kHz */
+#define DVFS_CLOCK_STEP    100000 /* kHz */
+#define DVFS_WINDOW        30     /* frames */
+#define DVFS_UP_LOAD       90     /* %, worst frame in window */
+#define DVFS_DOWN_LOAD     80     /* %, worst frame predicted at lower clock */
+#define DVFS_DOWN_WINDOWS  4      /* consecutive windows before step down */
+#define DVFS_FAST_UP_STEPS 3      /* steps up on missed frame */
+#define DVFS_PROFILE_PCT   95     /* %, default percentile of learned clock */
+#define DVFS_PROFILE_MIN   1800   /* frames, minimum to learn */
+#define DVFS_PROFILE_MAX   256    /* entries of cpuclock.idx */
+static struct {
+   bool enabled;
+   uint32_t percentile;        /* % */
+   uint32_t content_crc;       /* crc32 of content path, 0 = none */
+   int learned;                /* kHz, 0 = none */
+   uint32_t hist[2400000 / DVFS_CLOCK_STEP + 1]; /* frames per clock */
+   int ceiling;                /* kHz */
+   int clock;                  /* kHz, 0 = inactive */
+   retro_time_t budget;        /* usec */
+   retro_time_t last_cpu;
+   bool present;               /* presenter thread running, present_clk valid */
+   clockid_t present_clk;      /* CPU clock of the presenter thread */
+   retro_time_t last_present_cpu;
+   retro_time_t last_frame;
+   retro_time_t busy_max;
+   uint32_t dupes;             /* core runs without a frame (NULL / dupe) since the last one */
+   uint32_t frames;
+   uint32_t down_count;
+} dvfs;
+
+/* Thermal / battery governor
+ * Background thread samples the SoC temperature and battery level and
+ * lowers the clock ceiling before the kernel throttles, stepping back
+ * up with hysteresis. The ceiling is applied on the emulation thread. */
+#define THERMAL_FILE_PATH  "/mnt/SDCARD/.tmp_update/config/RetroArch/.thermalGov"
+#define THERMAL_ZONE_PATH  "/sys/class/thermal/thermal_zone0/temp"
+#define THERMAL_INTERVAL   2       /* sec */
+#define THERMAL_HOT        75000   /* m'C, step ceiling down */
+#define THERMAL_COOL       68000   /* m'C, step ceiling up */
+#define THERMAL_CLOCK_STEP 100000  /* kHz */
+#define THERMAL_CLOCK_MIN  800000  /* kHz, software prescaler is dropped at this ceiling */
+#define BATTERY_LOW        15      /* % */
+#define BATTERY_LOW_CLOCK  1000000 /* kHz, ceiling on low battery */
+static struct {
+   bool running;
+   bool quit;
+   pthread_t pt;
+   pthread_mutex_t mx;
+   pthread_cond_t cv;
+   int thermal_cap;            /* kHz, 0 = none */
+   volatile int cap;           /* kHz, effective ceiling, 0 = none */
+   volatile bool degrade;      /* drop software prescaler */
+   int applied;                /* kHz, cap applied on the emulation thread, -1 = reapply */
+} thermal;
+
+static void sdl_miyoomini_dvfs_set(int clock) {
+   if (clock > dvfs.ceiling) clock = dvfs.ceiling;
+   if (clock < DVFS_CLOCK_MIN) clock = DVFS_CLOCK_MIN;
+   if (clock == dvfs.clock) return;
+   set_cpuclock(clock);
+   dvfs.clock = clock;
+   RARCH_DBG("[CPU]: DVFS clock: %d MHz\n", clock / 1000);
+}
+
+static void sdl_miyoomini_dvfs_reset(int ceiling) {
+   double fps = video_state_get_ptr()->av_info.timing.fps;
+   dvfs.ceiling    = dvfs.clock = ceiling;
+   dvfs.budget     = (fps > 1.0) ? (retro_time_t)(1000000.0 / fps) : 16667;
+   dvfs.last_frame = 0;
+   dvfs.dupes      = 0;
+   dvfs.frames     = dvfs.down_count = 0;
+   dvfs.busy_max   = 0;
+   /* Start at the clock learned for the content */
+   if (dvfs.learned) sdl_miyoomini_dvfs_set(dvfs.learned);
+}
+
+/* Per-content clock profile
+ * cpuclock.idx in the core config dir, each line is "<crc32 of content path> <MHz>" */
+static void sdl_miyoomini_dvfs_profile_load(void) {
+   char path[PATH_MAX_LENGTH];
+   const char *content = path_get(RARCH_PATH_CONTENT);
+   uint32_t crc;
+   int mhz;
+   FILE *fp;
+
+   dvfs.content_crc = 0;
+   dvfs.learned     = 0;
+   memset(dvfs.hist, 0, sizeof(dvfs.hist));
+   dvfs.percentile  = DVFS_PROFILE_PCT;
+   /* percentile can be configured in the DVFS flag file */
+   if ((fp = fopen(DVFS_FILE_PATH, "r"))) {
+      uint32_t pct = 0;
+      if ((fscanf(fp, "%u", &pct) == 1) && pct && (pct <= 100)) dvfs.percentile = pct;
+      fclose(fp);
+   }
+
+   if (string_is_empty(content)) return;
+   dvfs.content_crc = encoding_crc32(0, (const uint8_t*)content, strlen(content));
+   if (!__get_cpuclock_path(path, ".idx") || !(fp = fopen(path, "r"))) return;
+   while (fscanf(fp, "%x %d", &crc, &mhz) == 2) {
+      if (crc == dvfs.content_crc) {
+         dvfs.learned = mhz * 1000;
+         RARCH_LOG("[CPU]: Learned clock for content: %d MHz\n", mhz);
+         break;
+      }
+   }
+   fclose(fp);
+}
+
+static void sdl_miyoomini_dvfs_profile_save(void) {
+   char path[PATH_MAX_LENGTH];
+   uint32_t crcs[DVFS_PROFILE_MAX];
+   int mhzs[DVFS_PROFILE_MAX];
+   uint32_t i, count = 0, total = 0, sum = 0, crc;
+   int mhz, clock = 0;
+   FILE *fp;
+
+   if (!dvfs.enabled || !dvfs.content_crc) return;
+   for (i = 0; i < sizeof(dvfs.hist) / sizeof(dvfs.hist[0]); i++) total += dvfs.hist[i];
+   if (total < DVFS_PROFILE_MIN) return;
+
+   /* clock which sustained the percentile of frames */
+   for (i = 0; i < sizeof(dvfs.hist) / sizeof(dvfs.hist[0]); i++) {
+      sum += dvfs.hist[i];
+      if ((uint64_t)sum * 100 >= (uint64_t)total * dvfs.percentile) { clock = i * (DVFS_CLOCK_STEP / 1000); break; }
+   }
+   if (!clock || !__get_cpuclock_path(path, ".idx")) return;
+
+   /* read index, drop the entry of the content and the oldest one if full */
+   if ((fp = fopen(path, "r"))) {
+      while ((count < DVFS_PROFILE_MAX) && (fscanf(fp, "%x %d", &crc, &mhz) == 2)) {
+         if (crc == dvfs.content_crc) continue;
+         crcs[count] = crc; mhzs[count++] = mhz;
+      }
+      fclose(fp);
+   }
+   if (!(fp = fopen(path, "w"))) return;
+   for (i = (count == DVFS_PROFILE_MAX) ? 1 : 0; i < count; i++) fprintf(fp, "%08x %d\n", crcs[i], mhzs[i]);
+   fprintf(fp, "%08x %d\n", dvfs.content_crc, clock);
+   fclose(fp);
+   RARCH_LOG("[CPU]: Saved clock for content: %d MHz (%u%% of %u frames)\n", clock, dvfs.percentile, total);
+}
+
+/* Call after present of every content frame */
+static void sdl_miyoomini_dvfs_frame(bool fastforward) {
+   struct timespec ts;
+   uint32_t runs = dvfs.dupes + 1;
+   dvfs.dupes = 0;
+   if (!dvfs.enabled || !dvfs.clock) return;
+
+   clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+   retro_time_t cpu      = (retro_time_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+   retro_time_t now      = cpu_features_get_time_usec();
+   retro_time_t busy     = cpu - dvfs.last_cpu;
+   retro_time_t interval = now - dvfs.last_frame;
+   bool first            = !dvfs.last_frame;
+   dvfs.last_cpu   = cpu;
+   dvfs.last_frame = now;
+   /* The presenter runs on the other core in parallel, the frame rate is held
+    * by whichever thread is busier */
+   if (dvfs.present && !clock_gettime(dvfs.present_clk, &ts)) {
+      retro_time_t present_cpu = (retro_time_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+      if (present_cpu - dvfs.last_present_cpu > busy) busy = present_cpu - dvfs.last_present_cpu;
+      dvfs.last_present_cpu = present_cpu;
+   }
+   if (first) return;
+
+   /* Full clock while fast forwarding, restart window after stall (loading etc) */
+   if (fastforward || interval > 100000) {
+      if (fastforward) sdl_miyoomini_dvfs_set(dvfs.ceiling);
+      dvfs.frames = dvfs.down_count = 0; dvfs.busy_max = 0;
+      return;
+   }
+   /* Missed frame, fast up-ramp. Cores that dupe frames (or run at half rate)
+    * present once every runs core runs, compare against that many budgets */
+   if (interval > dvfs.budget * runs * 3 / 2) {
+      sdl_miyoomini_dvfs_set(dvfs.clock + DVFS_CLOCK_STEP * DVFS_FAST_UP_STEPS);
+      dvfs.frames = dvfs.down_count = 0; dvfs.busy_max = 0;
+      return;
+   }
 
-	munmap(pll_map, PLL_SIZE);
-	close(fd_mem);
+   dvfs.hist[(dvfs.clock + DVFS_CLOCK_STEP - 1) / DVFS_CLOCK_STEP]++;
+   busy /= runs;
+   if (busy > dvfs.busy_max) dvfs.busy_max = busy;
+   if (++dvfs.frames < DVFS_WINDOW) return;
+
+   /* Hysteresis, up immediately, down after DVFS_DOWN_WINDOWS windows */
+   uint32_t load = dvfs.busy_max * 100 / dvfs.budget;
+   int lower     = dvfs.clock - DVFS_CLOCK_STEP;
+   if (load > DVFS_UP_LOAD) {
+      sdl_miyoomini_dvfs_set(dvfs.clock + DVFS_CLOCK_STEP);
+      dvfs.down_count = 0;
+   } else if ((lower >= DVFS_CLOCK_MIN) && ((int64_t)load * dvfs.clock / lower < DVFS_DOWN_LOAD)) {
+      if (++dvfs.down_count >= DVFS_DOWN_WINDOWS) {
+         sdl_miyoomini_dvfs_set(lower);
+         dvfs.down_count = 0;
+      }
+   } else dvfs.down_count = 0;
+   dvfs.frames   = 0;
+   dvfs.busy_max = 0;
 }
 
 /* Set CPU governor */
 enum cpugov { PERFORMANCE = 0, POWERSAVE = 1, ONDEMAND = 2, USERSPACE = 3 };
-static void sdl_miyoomini_set_cpugovernor(enum cpugov gov) {
-   const char govstr[4][12] = { "performance", "powersave", "ondemand", "userspace" };
+static const char govstr[4][12] = { "performance", "powersave", "ondemand", "userspace" };
+static const char fn_governor[] = "/sys/devices/system/cpu/cpufreq/policy0/scaling_governor";
+static const char fn_setspeed[] = "/sys/devices/system/cpu/cpufreq/policy0/scaling_setspeed";
+
+/* Last applied governor / clock, staged to be restored on resume from suspend
+ * without reading cpuclock.txt again */
+static struct {
+   pthread_mutex_t lock;
+   enum cpugov gov;
+   int clock;                  /* kHz, USERSPACE clock, 0 = governor only */
+} cpugov_state = { PTHREAD_MUTEX_INITIALIZER };
+
+static void sdl_miyoomini_apply_cpugovernor(enum cpugov gov) {
    const char fn_min_freq[] = "/sys/devices/system/cpu/cpufreq/policy0/scaling_min_freq";
-   const char fn_governor[] = "/sys/devices/system/cpu/cpufreq/policy0/scaling_governor";
-   const char fn_setspeed[] = "/sys/devices/system/cpu/cpufreq/policy0/scaling_setspeed";
    static uint32_t minfreq = 0;
    FILE* fp;
 
+   cpugov_state.gov   = gov;
+   cpugov_state.clock = 0;
+   thermal.applied    = -1;
+
    if (!minfreq) {
       /* save min_freq */
       fp = fopen(fn_min_freq, "r");
@@ -555,21 +1046,28 @@ static void sdl_miyoomini_set_cpugovernor(enum cpugov gov) {
       minfreq = 0;
    }
 
+   dvfs.clock = 0;
+
    /* set cpu clock to value in cpuclock.txt */
    if (gov == PERFORMANCE) {
+      int cpuclock = 0;
       fp = __get_cpuclock_file();
-      if (fp) {
-         int cpuclock = 0;
-         fscanf(fp, "%d", &cpuclock); fclose(fp);
-         if ((cpuclock >= 100)&&(cpuclock <= 2400)) {
-            fp = fopen(fn_governor, "w");
-            if (fp) { fwrite(govstr[USERSPACE], 1, strlen(govstr[USERSPACE]), fp); fclose(fp); }
-            fp = fopen(fn_setspeed, "w");
-            if (fp) { fprintf(fp, "%d", cpuclock * 1000); fclose(fp); }
-            set_cpuclock(cpuclock * 1000);
-            RARCH_LOG("[CPU]: Set clock: %d MHz\n", cpuclock);
-            return;
-         }
+      if (fp) { fscanf(fp, "%d", &cpuclock); fclose(fp); }
+      if ( !((cpuclock >= 100)&&(cpuclock <= 2400)) && dvfs.enabled ) {
+         /* DVFS without cpuclock.txt, ceiling = max freq */
+         fp = fopen("/sys/devices/system/cpu/cpufreq/policy0/cpuinfo_max_freq", "r");
+         if (fp) { fscanf(fp, "%d", &cpuclock); fclose(fp); cpuclock /= 1000; }
+      }
+      if ((cpuclock >= 100)&&(cpuclock <= 2400)) {
+         fp = fopen(fn_governor, "w");
+         if (fp) { fwrite(govstr[USERSPACE], 1, strlen(govstr[USERSPACE]), fp); fclose(fp); }
+         fp = fopen(fn_setspeed, "w");
+         if (fp) { fprintf(fp, "%d", cpuclock * 1000); fclose(fp); }
+         set_cpuclock(cpuclock * 1000);
+         cpugov_state.clock = cpuclock * 1000;
+         RARCH_LOG("[CPU]: Set clock: %d MHz%s\n", cpuclock, dvfs.enabled ? " (DVFS ceiling)" : "");
+         if (dvfs.enabled) sdl_miyoomini_dvfs_reset(cpuclock * 1000);
+         return;
       }
    }
 
@@ -578,21 +1076,33 @@ static void sdl_miyoomini_set_cpugovernor(enum cpugov gov) {
    if (fp) { fwrite(govstr[gov], 1, strlen(govstr[gov]), fp); fclose(fp); }
 }
 
+static void sdl_miyoomini_set_cpugovernor(enum cpugov gov) {
+   pthread_mutex_lock(&cpugov_state.lock);
+   sdl_miyoomini_apply_cpugovernor(gov);
+   pthread_mutex_unlock(&cpugov_state.lock);
+}
+
 static void sdl_miyoomini_toggle_powersave(bool state) {
    sdl_miyoomini_set_cpugovernor(state ? POWERSAVE : PERFORMANCE);
 }
 
-static void sdl_miyoomini_sighandler(int sig) {
-   switch (sig) {
-   case SIGSTOP:
-      sdl_miyoomini_toggle_powersave(true);
-      break;
-   case SIGCONT:
-      sdl_miyoomini_toggle_powersave(false);
-      break;
-   default:
-      break;
+/* Resume from suspend (SIGCONT), called on the suspend service thread.
+ * The launcher may have changed the governor while we were stopped,
+ * write back the staged one. MPLL is set on the emulation thread
+ * at the next frame, as DVFS changes it from there. */
+static void sdl_miyoomini_resume(void *data) {
+   enum cpugov gov;
+   FILE* fp;
+
+   pthread_mutex_lock(&cpugov_state.lock);
+   gov = cpugov_state.clock ? USERSPACE : cpugov_state.gov;
+   fp = fopen(fn_governor, "w");
+   if (fp) { fwrite(govstr[gov], 1, strlen(govstr[gov]), fp); fclose(fp); }
+   if (cpugov_state.clock) {
+      fp = fopen(fn_setspeed, "w");
+      if (fp) { fprintf(fp, "%d", cpugov_state.clock); fclose(fp); }
    }
+   pthread_mutex_unlock(&cpugov_state.lock);
 }
 
 static void sdl_miyoomini_init_font_color(sdl_miyoomini_video_t *vid) {
@@ -609,28 +1119,255 @@ static void sdl_miyoomini_init_font_color(sdl_miyoomini_video_t *vid) {
 
    /* Convert to XRGB8888 */
    vid->font_colour32 = (red << 16) | (green << 8) | blue;
+   /* Convert to RGB565 */
+   vid->font_colour16 = ((red >> 3) << 11) | ((green >> 2) << 5) | (blue >> 3);
+}
+
+static void sdl_miyoomini_dup_stats(sdl_miyoomini_video_t *vid) {
+   rarch_system_info_t *system = &runloop_state_get_ptr()->system;
+   const char *core_name = system ? system->info.library_name : NULL;
+
+   if (vid->dup_total)
+      RARCH_LOG("[MI_GFX]: Duplicate frames skipped for %s: %u of %u (%u%%)\n",
+            string_is_empty(core_name) ? "content" : core_name,
+            vid->dup_count, vid->dup_total, vid->dup_count * 100 / vid->dup_total);
+   vid->dup_count = vid->dup_total = 0;
+}
+
+static void sdl_miyoomini_free_direct(sdl_miyoomini_video_t* vid) {
+   uint32_t i;
+   if (vid->shown != vid->screen) vid->shown = NULL;
+   vid->filter_target.data     = NULL;
+   vid->filter_target.replaced = NULL;
+   if (!vid->direct[0]) return;
+   GFX_WaitAllDone();
+   for (i = 0; i < DIRECT_RING; i++) {
+      if (vid->direct[i]) GFX_FreeSurface(vid->direct[i]);
+      vid->direct[i] = NULL;
+   }
+   vid->direct_idx = 0;
+}
+
+/* Direct buffer the frame was rendered into, NULL for core's own buffer */
+static SDL_Surface *sdl_miyoomini_direct_surface(sdl_miyoomini_video_t* vid, const void *frame) {
+   uint32_t i;
+   for (i = 0; i < DIRECT_RING; i++)
+      if (vid->direct[i] && (frame == vid->direct[i]->pixels)) return vid->direct[i];
+   return NULL;
+}
+
+/* Next direct buffer of the ring, once the presenter and the blit from it are done */
+static SDL_Surface *sdl_miyoomini_direct_next(sdl_miyoomini_video_t* vid) {
+   SDL_Surface **direct = &vid->direct[vid->direct_idx];
+   if (unlikely(!*direct)) {
+      *direct = GFX_CreateRGBSurface(0, vid->content_width, vid->content_height, vid->rgb32 ? 32 : 16, 0, 0, 0, 0);
+      if (!*direct) { vid->direct_ok = false; return NULL; }
+      RARCH_LOG("[MI_GFX]: Direct software framebuffer %u: %ux%u\n", vid->direct_idx, vid->content_width, vid->content_height);
+   }
+   if (vid->presenter) {
+      pthread_mutex_lock(&vid->present_mx);
+      while ((vid->present_cur == (*direct)->pixels) ||
+             (vid->present_pending && (vid->present_job.frame == (*direct)->pixels)))
+         pthread_cond_wait(&vid->present_cv, &vid->present_mx);
+      pthread_mutex_unlock(&vid->present_mx);
+   }
+   MI_GFX_WaitAllDone(FALSE, flipFence);
+   return *direct;
+}
+
+/* Hand the direct buffers to the softfilter plugin instantiated by the frontend as its output.
+ * The library stays owned by the frontend, the filter is freed after the driver */
+static void sdl_miyoomini_filter_target_init(sdl_miyoomini_video_t* vid) {
+#ifdef HAVE_DYLIB
+   rarch_softfilter_t *filt = video_state_get_ptr()->state_filter;
+   dylib_t lib;
+
+   /* builtin filters have no library and keep the frontend buffer */
+   if (!filt || !(lib = rarch_softfilter_get_dylib(filt))) return;
+   vid->filter_set = (softfilter_set_output_target_t)dylib_proc(lib, SOFTFILTER_SET_OUTPUT_TARGET_SYM);
+   if (!vid->filter_set) return;
+   vid->filter_set(&vid->filter_target);
+   RARCH_LOG("[MI_GFX]: Softfilter renders into direct buffers\n");
+#endif
+}
+
+static void sdl_miyoomini_filter_target_free(sdl_miyoomini_video_t* vid) {
+   if (vid->filter_set) vid->filter_set(NULL);
+   vid->filter_set = NULL;
+}
+
+/* Offer the next direct buffer to the softfilter for the next frame, its output
+ * is then shown like a frame rendered directly by the core (HW blit only at 1x) */
+static void sdl_miyoomini_filter_target_next(sdl_miyoomini_video_t* vid) {
+   SDL_Surface *direct = NULL;
+   if (likely(!vid->filter_set)) return;
+   if (vid->direct_ok || vid->presenter) direct = sdl_miyoomini_direct_next(vid);
+   vid->filter_target.data   = direct ? direct->pixels : NULL;
+   vid->filter_target.pitch  = direct ? direct->pitch : 0;
+   vid->filter_target.width  = vid->content_width;
+   vid->filter_target.height = vid->content_height;
+}
+
+/* Wait until the presenter thread has shown all frames handed over */
+static void sdl_miyoomini_present_drain(sdl_miyoomini_video_t* vid) {
+   if (!vid->presenter) return;
+   pthread_mutex_lock(&vid->present_mx);
+   while (vid->present_pending || vid->present_busy) pthread_cond_wait(&vid->present_cv, &vid->present_mx);
+   pthread_mutex_unlock(&vid->present_mx);
+}
+
+static void sdl_miyoomini_present_stop(sdl_miyoomini_video_t* vid) {
+   if (!vid->presenter) return;
+   pthread_mutex_lock(&vid->present_mx);
+   vid->present_quit = true;
+   pthread_cond_broadcast(&vid->present_cv);
+   pthread_mutex_unlock(&vid->present_mx);
+   dvfs.present = false;
+   pthread_join(vid->present_pt, NULL);
+   miyoo_thread_policy_unregister(MIYOO_THREAD_PRESENT);
+   pthread_mutex_destroy(&vid->present_mx);
+   pthread_cond_destroy(&vid->present_cv);
+   vid->presenter = false;
+   if (vid->present_drops) RARCH_LOG("[MI_GFX]: Presenter: %u frames replaced before shown\n", vid->present_drops);
+}
+
+static void sdl_miyoomini_thermal_stop(void) {
+   if (!thermal.running) return;
+   pthread_mutex_lock(&thermal.mx);
+   thermal.quit = true;
+   pthread_cond_signal(&thermal.cv);
+   pthread_mutex_unlock(&thermal.mx);
+   pthread_join(thermal.pt, NULL);
+   pthread_mutex_destroy(&thermal.mx);
+   pthread_cond_destroy(&thermal.cv);
+   thermal.running = false;
+   thermal.cap     = 0;
+   thermal.degrade = false;
+}
+
+#ifdef HAVE_OVERLAY
+static void sdl_miyoomini_overlay_free_images(sdl_miyoomini_video_t *vid) {
+   unsigned i;
+   if (vid->overlay_images) {
+      for (i = 0; i < vid->overlay_count; i++)
+         if (vid->overlay_images[i].surface) GFX_FreeSurface(vid->overlay_images[i].surface);
+      free(vid->overlay_images);
+   }
+   vid->overlay_images = NULL;
+   vid->overlay_count  = 0;
+   vid->overlay_dirty  = false;
+}
+
+/* Compose overlay images into overlay_surface (rotate180). Image 0 is copied, the others
+ * are blended over it with their alpha relative to image 0, whose alpha is applied at flip */
+static void sdl_miyoomini_overlay_compose(sdl_miyoomini_video_t *vid) {
+   unsigned i;
+   SDL_Surface *ovr = vid->overlay_surface;
+
+   vid->overlay_dirty = false;
+   GFX_SetupOverlaySurface(NULL);
+   if (!ovr) return;
+   GFX_FillRect(ovr, NULL, 0);
+
+   for (i = 0; i < vid->overlay_count; i++) {
+      sdl_miyoomini_overlay_image_t *img = &vid->overlay_images[i];
+      SDL_Rect rect;
+      if (!img->surface) continue;
+      rect.w = img->w * res_x;
+      rect.h = img->h * res_y;
+      if ((rect.w <= 0) || (rect.h <= 0)) continue;
+      /* for rotate180 */
+      rect.x = res_x - (int)(img->x * res_x) - rect.w;
+      rect.y = res_y - (int)(img->y * res_y) - rect.h;
+      if (!i) img->surface->flags &= ~SDL_SRCALPHA;
+      else {
+         uint32_t base  = vid->overlay_images[0].alpha ? vid->overlay_images[0].alpha : 0xFF;
+         uint32_t value = img->alpha * 0xFF / base;
+         img->surface->flags |= SDL_SRCALPHA;
+         img->surface->format->alpha = (value > 0xFF) ? 0xFF : value;
+      }
+      GFX_BlitSurfaceRotate(img->surface, NULL, ovr, &rect, 2);
+   }
+   if (vid->overlay_enabled) GFX_SetupOverlaySurface(ovr);
+}
+#endif
+
+/* Deep pause by the external UI: show nothing new, minimum clock.
+ * The flip thread sleeps on its condition without flip requests or callback. */
+static void sdl_miyoomini_deep_pause(bool paused, void *data) {
+   sdl_miyoomini_video_t *vid = (sdl_miyoomini_video_t*)data;
+
+   if (paused) {
+      sdl_miyoomini_present_drain(vid);
+      GFX_SetFlipCallback(NULL, NULL);
+      GFX_WaitAllDone();
+      sdl_miyoomini_toggle_powersave(true);
+   } else if (!vid->menu_active) sdl_miyoomini_toggle_powersave(false);
+}
+
+/* First frame after resume from suspend, on the emulation thread.
+ * Restore the staged clock and redraw entire pages, others may have
+ * drawn on the framebuffer while we were stopped. */
+static void sdl_miyoomini_resumed(sdl_miyoomini_video_t *vid) {
+   int clock;
+
+   vid->resume_seq = miyoo_resume_seq();
+   sdl_miyoomini_present_drain(vid);
+   GFX_ResetFlipState();
+   vid->menu_dirty = true;
+
+   pthread_mutex_lock(&cpugov_state.lock);
+   clock = cpugov_state.clock;
+   thermal.applied = -1;
+   if (clock) {
+      set_cpuclock(clock);
+      if (dvfs.enabled) sdl_miyoomini_dvfs_reset(clock);
+   }
+   pthread_mutex_unlock(&cpugov_state.lock);
+}
+
+/* Drop the fast forward drop prediction of sdl_miyoomini_gfx_focus, the core
+ * is told video is enabled again. The prediction is driver-owned state
+ * (miyoo_video_skip), the frontend keeps calling frame() which clears it */
+static void sdl_miyoomini_ff_video_restore(sdl_miyoomini_video_t *vid) {
+   if (likely(!vid->ff_video_off)) return;
+   miyoo_video_skip_set(false);
+   vid->ff_video_off = false;
 }
 
 static void sdl_miyoomini_gfx_free(void *data) {
    sdl_miyoomini_video_t *vid = (sdl_miyoomini_video_t*)data;
    if (unlikely(!vid)) return;
 
+   sdl_miyoomini_ff_video_restore(vid);
+   miyoo_resume_unregister();
+   miyoo_deep_pause_unregister(sdl_miyoomini_deep_pause);
+   sdl_miyoomini_thermal_stop();
+   sdl_miyoomini_filter_target_free(vid);
+   sdl_miyoomini_present_stop(vid);
    if (GFX_GetFlipCallback()) {
       GFX_SetFlipCallback(NULL, NULL); usleep(0x2000); /* wait for finish callback */
    }
    GFX_WaitAllDone();
    if (vid->screen) GFX_FreeSurface(vid->screen);
-   if (vid->menuscreen) GFX_FreeSurface(vid->menuscreen);
    if (vid->menuscreen_rgui) GFX_FreeSurface(vid->menuscreen_rgui);
+   if (vid->capture) GFX_FreeSurface(vid->capture);
+   sdl_miyoomini_free_direct(vid);
+   sdl_miyoomini_dup_stats(vid);
+   if (vid->osd_atlas) { GFX_SetFlipBlits(NULL, NULL, NULL, 0); GFX_FreeSurface(vid->osd_atlas); }
+   if (vid->notify[0]) { GFX_SetFlipLayer(NULL, NULL, 0, 0); GFX_FreeSurface(vid->notify[0]); GFX_FreeSurface(vid->notify[1]); }
 #ifdef HAVE_OVERLAY
    if (vid->overlay_surface) { GFX_SetupOverlaySurface(NULL); GFX_FreeSurface(vid->overlay_surface); }
+   sdl_miyoomini_overlay_free_images(vid);
 #endif
+   miyoo_thread_policy_unregister(MIYOO_THREAD_FLIP);
    GFX_Quit();
 
    if (vid->osd_font) bitmapfont_free_lut(vid->osd_font);
 
    free(vid);
 
+   sdl_miyoomini_dvfs_profile_save();
    sdl_miyoomini_set_cpugovernor(ONDEMAND);
 }
 
@@ -647,9 +1384,6 @@ static void sdl_miyoomini_input_driver_init(
     * initialise anything... */
    if (string_is_empty(input_drv_name)) return;
 
-   signal(SIGSTOP, sdl_miyoomini_sighandler);
-   signal(SIGCONT, sdl_miyoomini_sighandler);
-
    if (string_is_equal(input_drv_name, "sdl_dingux")) {
       *input_data = input_driver_init_wrap(&input_sdl_dingux,
             joypad_drv_name);
@@ -686,6 +1420,7 @@ static void sdl_miyoomini_input_driver_init(
 }
 
 static void sdl_miyoomini_set_output(sdl_miyoomini_video_t* vid, unsigned width, unsigned height, bool rgb32) {
+   sdl_miyoomini_present_drain(vid);
    vid->content_width  = width;
    vid->content_height = height;
    if (vid->rotate & 1) { width = vid->content_height; height = vid->content_width; }
@@ -759,6 +1494,20 @@ static void sdl_miyoomini_set_output(sdl_miyoomini_video_t* vid, unsigned width,
         { &scale4x1_32, &scale4x2_32, &scale4x3_32, &scale4x4_32 } }
    };
 
+   /* Thermal governor at the lowest ceiling, leave all scaling to HW */
+   if (vid->scaler_degraded && ((scale_xmul > 1) || (scale_ymul > 1))) scale_xmul = scale_ymul = 1;
+
+   /* 1x layout is scaled by HW only, cores may render into GFX surface directly */
+   vid->direct_ok = (scale_xmul == 1) && (scale_ymul == 1);
+   /* Direct buffers only depend on the content size, the frame may be in one
+    * when the scaler is changed by the thermal governor */
+   if (vid->direct[0] && ((vid->direct[0]->w != vid->content_width) ||
+         (vid->direct[0]->h != vid->content_height) ||
+         (vid->direct[0]->format->BitsPerPixel != (rgb32 ? 32 : 16))))
+      sdl_miyoomini_free_direct(vid);
+   vid->filter_target.data = NULL;
+   vid->dup_frame = NULL;
+
    if (!scale_xmul) {
       vid->scale_func = rgb32 ? scalenn_32 : scalenn_16;
    } else {
@@ -771,13 +1520,337 @@ static void sdl_miyoomini_set_output(sdl_miyoomini_video_t* vid, unsigned width,
    /* Attempt to change video mode */
    GFX_WaitAllDone();
    if (vid->screen) GFX_FreeSurface(vid->screen);
+   vid->shown  = NULL;
    vid->screen = GFX_CreateRGBSurface(
          0, vid->frame_width, vid->frame_height, rgb32 ? 32 : 16, 0, 0, 0, 0);
 
    /* Check whether selected display mode is valid */
+   /* Border is cleared by GFX_UpdateRect for each page */
    if (unlikely(!vid->screen)) RARCH_ERR("[MI_GFX]: Failed to init GFX surface\n");
-   /* Clear border */
-   else if (!vid->menu_active) sdl_miyoomini_clear_border(fb_addr, vid->video_x, vid->video_y, vid->video_w, vid->video_h);
+}
+
+static void sdl_miyoomini_set_menu_rect(void) {
+   rgui_menu_stretch = !(access(RGUI_MENU_STRETCH_FILE_PATH, F_OK) == 0 ||
+         (res_x == SDL_MIYOOMINI_WIDTH && res_y == SDL_MIYOOMINI_HEIGHT));
+   if (!rgui_menu_stretch) RARCH_LOG("[MI_GFX]: Menu stretch disabled\n");
+
+   rgui_menu_dest_rect = (SDL_Rect){(res_x - RGUI_MENU_WIDTH * 2) / 2, (res_y - RGUI_MENU_HEIGHT * 2) / 2, RGUI_MENU_WIDTH * 2, RGUI_MENU_HEIGHT * 2};
+}
+
+/* Switch display mode in place, without reinitialising the driver */
+static void sdl_miyoomini_set_resolution(sdl_miyoomini_video_t *vid, unsigned width, unsigned height) {
+   if ((width == res_x) && (height == res_y)) return;
+
+   sdl_miyoomini_present_drain(vid);
+   miyoo_thread_policy_unregister(MIYOO_THREAD_FLIP);
+   if (GFX_SetResolution(width, height))
+      RARCH_ERR("[MI_GFX]: Failed to set resolution %ux%u\n", width, height);
+   miyoo_thread_policy_register(MIYOO_THREAD_FLIP, flip_pt);
+   RARCH_LOG("[MI_GFX]: Resolution: %ux%u\n", res_x, res_y);
+
+   sdl_miyoomini_set_menu_rect();
+#ifdef HAVE_OVERLAY
+   /* Overlay is prepared at FB size, compose it again */
+   if (vid->overlay_surface) {
+      SDL_Surface *ovr = GFX_CreateRGBSurface(0, res_x, res_y, 32,
+            0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
+      GFX_SetupOverlaySurface(NULL);
+      if (ovr) {
+         ovr->flags |= vid->overlay_surface->flags & SDL_SRCALPHA;
+         ovr->format->alpha = vid->overlay_surface->format->alpha;
+      }
+      GFX_FreeSurface(vid->overlay_surface);
+      vid->overlay_surface = ovr;
+      sdl_miyoomini_overlay_compose(vid);
+   }
+#endif
+   /* OSD text is laid out from the right edge, compose again */
+   if (vid->osd_shown) {
+      GFX_SetFlipBlits(NULL, NULL, NULL, 0);
+      vid->osd_shown = false;
+   }
+   if (vid->notify[0]) {
+      GFX_SetFlipLayer(NULL, NULL, 0, 0);
+      GFX_WaitAllDone();
+      sdl_miyoomini_init_notify(vid);
+   }
+   vid->menu_dirty = true;
+   sdl_miyoomini_set_output(vid, vid->content_width, vid->content_height, vid->rgb32);
+}
+
+/* FNV-1a like 32bit hash, size must be a multiple of 16
+ * 4 lanes of 32bit words, the NEON path gives the same result as the C loop */
+static uint32_t sdl_miyoomini_hash_frame(const void* frame, uint32_t size) {
+   const uint32_t* src = (const uint32_t*)frame;
+   uint32_t h0 = 0x811C9DC5, h1 = 0x01000193, h2 = 0x9E3779B9, h3 = 0x85EBCA6B;
+
+#ifdef __ARM_NEON__
+   const uint32_t seed[4] = { h0, h1, h2, h3 };
+   uint32x4_t h = vld1q_u32(seed);
+   uint32x4_t p = vdupq_n_u32(0x01000193);
+   for (size >>= 4; size; size--, src += 4) h = vmulq_u32(veorq_u32(h, vld1q_u32(src)), p);
+   h0 = vgetq_lane_u32(h, 0); h1 = vgetq_lane_u32(h, 1);
+   h2 = vgetq_lane_u32(h, 2); h3 = vgetq_lane_u32(h, 3);
+#else
+   for (size >>= 4; size; size--, src += 4) {
+      h0 = (h0 ^ src[0]) * 0x01000193;
+      h1 = (h1 ^ src[1]) * 0x01000193;
+      h2 = (h2 ^ src[2]) * 0x01000193;
+      h3 = (h3 ^ src[3]) * 0x01000193;
+   }
+#endif
+   h0 ^= (h1 << 7) ^ (h1 >> 25);
+   h0 ^= (h2 << 13) ^ (h2 >> 19);
+   h0 ^= (h3 << 23) ^ (h3 >> 9);
+   /* 0 is reserved for "no frame yet" */
+   return h0 ? h0 : 1;
+}
+
+/* Hash the sampled rows (every DUP_SAMPLE_STEP-th) or the other rows of a frame,
+ * tail bytes of the rows are hashed one by one */
+static uint32_t sdl_miyoomini_hash_rows(const void* frame, uint32_t row_bytes,
+      uint32_t height, uint32_t pitch, bool sampled) {
+   const uint8_t* row = (const uint8_t*)frame;
+   uint32_t chunk     = row_bytes & ~15;
+   uint32_t h         = 0x811C9DC5;
+
+   for (uint32_t y = 0; y < height; y++, row += pitch) {
+      if (!(y % DUP_SAMPLE_STEP) != sampled) continue;
+      if (chunk) h = (h ^ sdl_miyoomini_hash_frame(row, chunk)) * 0x01000193;
+      for (uint32_t i = chunk; i < row_bytes; i++) h = (h ^ row[i]) * 0x01000193;
+   }
+   return h ? h : 1;
+}
+
+/* Detect a repeated frame (same pointer and contents as the last one).
+ * The sampled rows are compared first, the other rows confirm a repeat.
+ * Both hashes are kept for every frame reusing the pointer, so the hash of
+ * the last frame is always valid however long the content kept changing.
+ * A new pointer cannot repeat yet, only its sampled rows are hashed */
+static bool sdl_miyoomini_dup_frame(sdl_miyoomini_video_t *vid, const void *frame,
+      unsigned width, unsigned height, unsigned pitch) {
+   uint32_t row_bytes = width * (vid->rgb32 ? sizeof(uint32_t) : sizeof(uint16_t));
+   uint32_t sampled   = sdl_miyoomini_hash_rows(frame, row_bytes, height, pitch, true);
+   bool dup           = false;
+
+   vid->dup_total++;
+   if (frame == vid->dup_frame) {
+      uint32_t rest = sdl_miyoomini_hash_rows(frame, row_bytes, height, pitch, false);
+      dup = (sampled == vid->dup_sampled) && (rest == vid->dup_rest);
+      vid->dup_rest = rest;
+   } else vid->dup_rest = 0;
+
+   vid->dup_frame   = frame;
+   vid->dup_sampled = sampled;
+   if (dup) vid->dup_count++;
+   return dup;
+}
+
+/* Frame source has been read, the emulation thread may continue */
+static void sdl_miyoomini_present_release(sdl_miyoomini_video_t *vid) {
+   if (!vid->presenter) return;
+   pthread_mutex_lock(&vid->present_mx);
+   vid->present_cur = NULL;
+   pthread_cond_broadcast(&vid->present_cv);
+   pthread_mutex_unlock(&vid->present_mx);
+}
+
+/* Scale and flip a content frame, skip it when repeated */
+static void sdl_miyoomini_present(sdl_miyoomini_video_t *vid, const void *frame,
+      unsigned width, unsigned height, unsigned pitch, bool skip_ok) {
+   SDL_Surface *direct = sdl_miyoomini_direct_surface(vid, frame);
+
+   if (!direct && sdl_miyoomini_dup_frame(vid, frame, width, height, pitch) && skip_ok) {
+      sdl_miyoomini_present_release(vid);
+      /* Same frame is still on the current page, keep 60Hz pacing instead of blocking flip */
+      retro_time_t elapsed = cpu_features_get_time_usec() - vid->dup_frame_time;
+      if (vid->vsync && (elapsed >= 0) && (elapsed < 16667)) usleep(16667 - elapsed);
+   } else if (direct && vid->direct_ok) {
+      sdl_miyoomini_present_release(vid);
+      /* Core rendered into GFX surface, HW Blit it to Framebuffer and Flip as is */
+      GFX_UpdateRect(direct, vid->video_x, vid->video_y, vid->video_w, vid->video_h);
+      vid->shown = direct;
+   } else {
+      /* WaitAllDone to make sure the most recent frame is drawn complete */
+      MI_GFX_WaitAllDone(FALSE, flipFence);
+      /* SW Blit frame to GFX surface with scaling */
+      vid->scale_func(vid, (void*)frame, vid->screen->pixels, width, height, pitch, vid->screen->pitch);
+      sdl_miyoomini_present_release(vid);
+      /* HW Blit GFX surface to Framebuffer and Flip */
+      GFX_UpdateRect(vid->screen, vid->video_x, vid->video_y, vid->video_w, vid->video_h);
+      vid->shown = vid->screen;
+   }
+   vid->dup_frame_time = cpu_features_get_time_usec();
+}
+
+static void *sdl_miyoomini_present_thread(void *param) {
+   sdl_miyoomini_video_t *vid = (sdl_miyoomini_video_t*)param;
+
+   pthread_mutex_lock(&vid->present_mx);
+   for (;;) {
+      while (!vid->present_quit && !vid->present_pending) pthread_cond_wait(&vid->present_cv, &vid->present_mx);
+      if (vid->present_quit) break;
+      struct sdl_miyoomini_present_job job = vid->present_job;
+      vid->present_pending = false;
+      vid->present_busy    = true;
+      vid->present_cur     = job.frame;
+      pthread_cond_broadcast(&vid->present_cv);
+      pthread_mutex_unlock(&vid->present_mx);
+
+      sdl_miyoomini_present(vid, job.frame, job.width, job.height, job.pitch, job.skip_ok);
+
+      pthread_mutex_lock(&vid->present_mx);
+      vid->present_busy = false;
+      vid->present_cur  = NULL;
+      pthread_cond_broadcast(&vid->present_cv);
+   }
+   pthread_mutex_unlock(&vid->present_mx);
+   return NULL;
+}
+
+/* Hand a frame over to the presenter thread.
+ * Back-pressure matches the 3 FB pages: one frame pending while one is presented.
+ * With vsync a pending frame is never replaced, without vsync a pending direct
+ * buffer is replaced by the newer one. Core's own buffer is rewritten by the next
+ * retro_run, so the emulation thread waits until it has been read. */
+static void sdl_miyoomini_present_submit(sdl_miyoomini_video_t *vid, const void *frame,
+      unsigned width, unsigned height, unsigned pitch, bool skip_ok) {
+   bool direct = sdl_miyoomini_direct_surface(vid, frame) != NULL;
+
+   pthread_mutex_lock(&vid->present_mx);
+   if (vid->present_pending) {
+      if (vid->vsync || !direct) {
+         while (vid->present_pending) pthread_cond_wait(&vid->present_cv, &vid->present_mx);
+      } else vid->present_drops++;
+   }
+   vid->present_job.frame   = frame;
+   vid->present_job.width   = width;
+   vid->present_job.height  = height;
+   vid->present_job.pitch   = pitch;
+   vid->present_job.skip_ok = skip_ok;
+   vid->present_pending     = true;
+   pthread_cond_broadcast(&vid->present_cv);
+   if (!direct) {
+      while (vid->present_pending || (vid->present_cur == frame))
+         pthread_cond_wait(&vid->present_cv, &vid->present_mx);
+   }
+   pthread_mutex_unlock(&vid->present_mx);
+}
+
+static void sdl_miyoomini_present_start(sdl_miyoomini_video_t *vid) {
+   pthread_mutex_init(&vid->present_mx, NULL);
+   pthread_cond_init(&vid->present_cv, NULL);
+   if (pthread_create(&vid->present_pt, NULL, sdl_miyoomini_present_thread, vid)) {
+      RARCH_ERR("[MI_GFX]: Failed to start presenter thread\n");
+      pthread_mutex_destroy(&vid->present_mx);
+      pthread_cond_destroy(&vid->present_cv);
+      return;
+   }
+   vid->presenter = true;
+   miyoo_thread_policy_register(MIYOO_THREAD_PRESENT, vid->present_pt);
+   /* DVFS load also counts the presenter CPU time */
+   struct timespec ts;
+   if (!pthread_getcpuclockid(vid->present_pt, &dvfs.present_clk) && !clock_gettime(dvfs.present_clk, &ts)) {
+      dvfs.last_present_cpu = (retro_time_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+      dvfs.present = true;
+   }
+   RARCH_LOG("[MI_GFX]: Presenter thread\n");
+}
+
+static void *sdl_miyoomini_thermal_thread(void *arg) {
+   int last_cap = 0, temp, battery, base, cap;
+   struct timespec ts;
+   FILE *fp;
+
+   pthread_mutex_lock(&thermal.mx);
+   while (!thermal.quit) {
+      pthread_mutex_unlock(&thermal.mx);
+
+      temp = 0;
+      if ((fp = fopen(THERMAL_ZONE_PATH, "r"))) {
+         if (fscanf(fp, "%d", &temp) != 1) temp = 0;
+         fclose(fp);
+      }
+      battery = dingux_get_battery_level();
+
+      pthread_mutex_lock(&cpugov_state.lock);
+      base = cpugov_state.clock;
+      pthread_mutex_unlock(&cpugov_state.lock);
+
+      /* Caps apply to the USERSPACE clock only (not in menu / powersave) */
+      if (base) {
+         if (temp >= THERMAL_HOT) {
+            if (!thermal.thermal_cap || thermal.thermal_cap > base) thermal.thermal_cap = base;
+            thermal.thermal_cap -= THERMAL_CLOCK_STEP;
+            if (thermal.thermal_cap < THERMAL_CLOCK_MIN) thermal.thermal_cap = THERMAL_CLOCK_MIN;
+         } else if (thermal.thermal_cap && (temp < THERMAL_COOL)) {
+            thermal.thermal_cap += THERMAL_CLOCK_STEP;
+            if (thermal.thermal_cap >= base) thermal.thermal_cap = 0;
+         }
+         cap = thermal.thermal_cap;
+         if ((battery > 0) && (battery <= BATTERY_LOW) && (!cap || cap > BATTERY_LOW_CLOCK)) cap = BATTERY_LOW_CLOCK;
+         if (cap >= base) cap = 0;
+         thermal.degrade = (thermal.thermal_cap == THERMAL_CLOCK_MIN) && (temp >= THERMAL_HOT);
+         thermal.cap     = cap;
+         if (cap != last_cap)
+            RARCH_LOG("[CPU]: Thermal governor: %d.%d C, battery %d%%, ceiling %d MHz\n",
+                  temp / 1000, (temp % 1000) / 100, battery, (cap ? cap : base) / 1000);
+         last_cap = cap;
+      }
+
+      pthread_mutex_lock(&thermal.mx);
+      clock_gettime(CLOCK_REALTIME, &ts);
+      ts.tv_sec += THERMAL_INTERVAL;
+      if (!thermal.quit) pthread_cond_timedwait(&thermal.cv, &thermal.mx, &ts);
+   }
+   pthread_mutex_unlock(&thermal.mx);
+   return NULL;
+}
+
+static void sdl_miyoomini_thermal_start(void) {
+   thermal.quit        = false;
+   thermal.thermal_cap = 0;
+   thermal.cap         = 0;
+   thermal.degrade     = false;
+   thermal.applied     = -1;
+   pthread_mutex_init(&thermal.mx, NULL);
+   pthread_cond_init(&thermal.cv, NULL);
+   if (pthread_create(&thermal.pt, NULL, sdl_miyoomini_thermal_thread, NULL)) {
+      RARCH_ERR("[CPU]: Failed to start thermal governor thread\n");
+      pthread_mutex_destroy(&thermal.mx);
+      pthread_cond_destroy(&thermal.cv);
+      return;
+   }
+   thermal.running = true;
+   RARCH_LOG("[CPU]: Thermal governor\n");
+}
+
+/* Apply the thermal / battery ceiling, call before present of content frames */
+static void sdl_miyoomini_thermal_frame(sdl_miyoomini_video_t *vid) {
+   int cap = thermal.cap, base, clock;
+
+   if (!thermal.running) return;
+
+   if (unlikely(thermal.degrade != vid->scaler_degraded)) {
+      vid->scaler_degraded = thermal.degrade;
+      sdl_miyoomini_present_drain(vid);
+      sdl_miyoomini_set_output(vid, vid->content_width, vid->content_height, vid->rgb32);
+      RARCH_LOG("[MI_GFX]: Software prescaler %s\n", vid->scaler_degraded ? "dropped (thermal)" : "restored");
+   }
+
+   if (likely(cap == thermal.applied)) return;
+   pthread_mutex_lock(&cpugov_state.lock);
+   base = cpugov_state.clock;
+   if (base) {
+      thermal.applied = cap;
+      clock = (cap && (cap < base)) ? cap : base;
+      if (dvfs.enabled && dvfs.clock) {
+         /* DVFS steps up to the new ceiling by itself */
+         dvfs.ceiling = clock;
+         if (dvfs.clock > clock) sdl_miyoomini_dvfs_set(clock);
+      } else set_cpuclock(clock);
+   }
+   pthread_mutex_unlock(&cpugov_state.lock);
 }
 
 static void *sdl_miyoomini_gfx_init(const video_info_t *video,
@@ -788,11 +1861,17 @@ static void *sdl_miyoomini_gfx_init(const video_info_t *video,
    const char *input_drv_name                 = settings->arrays.input_driver;
    const char *joypad_drv_name                = settings->arrays.input_joypad_driver;
 
+   dvfs.enabled = (access(DVFS_FILE_PATH, F_OK) == 0);
+   if (dvfs.enabled) sdl_miyoomini_dvfs_profile_load();
    sdl_miyoomini_set_cpugovernor(PERFORMANCE);
+   if (access(THERMAL_FILE_PATH, F_OK) == 0) sdl_miyoomini_thermal_start();
 
    if (access(NEW_RES_FILE_PATH, F_OK) == 0) {
       RARCH_LOG("[MI_GFX]: 560p available, changing resolution\n");
-      system("/mnt/SDCARD/.tmp_update/script/change_resolution.sh 752x560");
+      /* vinfo is read right after, so this one has to complete */
+      static const char *const argv[] = {
+         "/mnt/SDCARD/.tmp_update/script/change_resolution.sh", "752x560", NULL };
+      miyoo_spawn_wait(argv);
    }
 
     int fb = open(FB_DEVICE_FILE_PATH, O_RDWR);
@@ -814,12 +1893,7 @@ static void *sdl_miyoomini_gfx_init(const video_info_t *video,
 
    RARCH_LOG("[MI_GFX]: Resolution: %ux%u\n", res_x, res_y);
 
-   if (access(RGUI_MENU_STRETCH_FILE_PATH, F_OK) == 0 || (res_x == 640 && res_y == 480)){
-      RARCH_LOG("[MI_GFX]: Menu stretch disabled\n");
-      rgui_menu_stretch = false;
-   }
-
-   rgui_menu_dest_rect = (SDL_Rect){(res_x - RGUI_MENU_WIDTH * 2) / 2, (res_y - RGUI_MENU_HEIGHT * 2) / 2, RGUI_MENU_WIDTH * 2, RGUI_MENU_HEIGHT * 2};
+   sdl_miyoomini_set_menu_rect();
    /* Initialise graphics subsystem, if required */
    if (sdl_subsystem_flags == 0) {
       if (SDL_Init(SDL_INIT_VIDEO) < 0) return NULL;
@@ -829,15 +1903,22 @@ static void *sdl_miyoomini_gfx_init(const video_info_t *video,
 
    vid = (sdl_miyoomini_video_t*)calloc(1, sizeof(*vid));
    if (!vid) return NULL;
-
+   vid->new_res_available = (access(NEW_RES_FILE_PATH, F_OK) == 0);
+
+   GFX_SetPrefault(miyoo_jitter_free_init());
+   /* RGB565 scan-out for 16bpp cores */
+   if (!video->rgb32 && access(FB_RGB565_FILE_PATH, F_OK) == 0) {
+      RARCH_LOG("[MI_GFX]: RGB565 framebuffer\n");
+      GFX_SetFrameBufferDepth(16);
+   } else GFX_SetFrameBufferDepth(32);
    GFX_Init();
+   miyoo_thread_policy_register(MIYOO_THREAD_EMU, pthread_self());
+   miyoo_thread_policy_register(MIYOO_THREAD_FLIP, flip_pt);
 
-   vid->menuscreen = GFX_CreateRGBSurface(
-         0, res_x, res_y, 16, 0, 0, 0, 0);
    vid->menuscreen_rgui = GFX_CreateRGBSurface(
          0, RGUI_MENU_WIDTH, RGUI_MENU_HEIGHT, 16, 0, 0, 0, 0);
 
-   if (!vid->menuscreen||!vid->menuscreen_rgui) {
+   if (!vid->menuscreen_rgui) {
       RARCH_ERR("[MI_GFX]: Failed to init GFX surface\n");
       goto error;
    }
@@ -857,6 +1938,10 @@ static void *sdl_miyoomini_gfx_init(const video_info_t *video,
    sdl_miyoomini_set_output(vid, vid->content_width, vid->content_height, vid->rgb32);
 
    GFX_SetFlipFlags(vid->vsync ? GFX_BLOCKING : 0);
+   if (access(PRESENTER_FILE_PATH, F_OK) == 0) sdl_miyoomini_present_start(vid);
+   miyoo_deep_pause_register(sdl_miyoomini_deep_pause, vid);
+   vid->resume_seq = miyoo_resume_seq();
+   miyoo_resume_register(sdl_miyoomini_resume, NULL);
 
    sdl_miyoomini_input_driver_init(input_drv_name,
          joypad_drv_name, input, input_data);
@@ -872,6 +1957,12 @@ static void *sdl_miyoomini_gfx_init(const video_info_t *video,
       RARCH_ERR("[SDL1]: Failed to init OSD font\n");
       goto error;
    }
+   sdl_miyoomini_init_osd_atlas(vid);
+   if (access(NOTIFY_FILE_PATH, F_OK) == 0) {
+      RARCH_LOG("[MI_GFX]: Notification layer\n");
+      sdl_miyoomini_init_notify(vid);
+   }
+   sdl_miyoomini_filter_target_init(vid);
 
    return vid;
 
@@ -888,6 +1979,13 @@ static bool sdl_miyoomini_gfx_frame(void *data, const void *frame,
    bool menu_is_alive      = (video_info->menu_st_flags & MENU_ST_FLAG_ALIVE) ? true : false;
 #endif
 
+   /* The drop prediction covers one core run, focus predicts the next one.
+    * Cleared before the early returns, a skipping core passes NULL frames */
+   if (likely(vid)) sdl_miyoomini_ff_video_restore(vid);
+
+   /* Skipped frame of the core, counted so DVFS does not see a missed frame */
+   if (unlikely(vid && !frame && !vid->menu_active)) { dvfs.dupes++; return true; }
+
    /* Return early if:
     * - Input sdl_miyoomini_video_t struct is NULL
     *   (cannot realistically happen)
@@ -918,46 +2016,91 @@ static bool sdl_miyoomini_gfx_frame(void *data, const void *frame,
       vid->last_frame_time = current_time;
    }
 
+   /* Repeated frame can be skipped only when nothing is drawn over it at flip */
+   bool skip_ok = !msg && !vid->osd_shown && !vid->was_in_menu;
+   if (unlikely(vid->resume_seq != miyoo_resume_seq())) { sdl_miyoomini_resumed(vid); skip_ok = false; }
+#ifdef HAVE_OVERLAY
+   /* Overlay images were moved or faded since the last frame */
+   if (unlikely(vid->overlay_dirty)) { sdl_miyoomini_overlay_compose(vid); skip_ok = false; }
+#endif
+
 #ifdef HAVE_MENU
    menu_driver_frame(menu_is_alive, video_info);
 #endif
 
-   /* Render OSD text at flip */
+   /* Render OSD text at flip, as glyph blits queued after the frame
+    * (updated only when the text changes) or by flip callback */
    if (msg) {
-      memcpy(vid->msg_tmp, msg, sizeof(vid->msg_tmp));
-      GFX_SetFlipCallback(sdl_miyoomini_print_msg, vid);
-   } else if (vid->msg_count) {
-      vid->msg_tmp[0] = 0;
-      GFX_SetFlipCallback(sdl_miyoomini_print_msg, vid);
+      if (vid->notify[0]) sdl_miyoomini_notify(vid, msg);
+      else if (likely(vid->osd_atlas)) {
+         if (!vid->osd_shown || strncmp(vid->msg_tmp, msg, sizeof(vid->msg_tmp))) {
+            memcpy(vid->msg_tmp, msg, sizeof(vid->msg_tmp));
+            GFX_SetFlipBlits(vid->osd_atlas, vid->osd_src, vid->osd_dst, sdl_miyoomini_layout_msg(vid));
+            vid->osd_shown = true;
+         }
+      } else {
+         memcpy(vid->msg_tmp, msg, sizeof(vid->msg_tmp));
+         GFX_SetFlipCallback(sdl_miyoomini_print_msg, vid);
+      }
    } else {
+      if (vid->osd_shown) {
+         if (vid->notify[0]) GFX_SetFlipLayer(NULL, NULL, 0, 0);
+         else GFX_SetFlipBlits(NULL, NULL, NULL, 0);
+         vid->osd_shown = false;
+      }
       GFX_SetFlipCallback(NULL, NULL);
    }
 
    if (likely(!vid->menu_active)) {
-      /* Clear border if we were in the menu on the previous frame */
+      /* Restore rotation if we were in the menu on the previous frame,
+       * menu area outside of the game is cleared by GFX_UpdateRect */
       if (unlikely(vid->was_in_menu)) {
-         sdl_miyoomini_clear_border(fb_addr, vid->video_x, vid->video_y, vid->video_w, vid->video_h);
          vid->was_in_menu = false;
          stOpt.eRotate = vid->rotate;
       }
+      /* Softfilter output is in a direct buffer instead of the frontend one */
+      if (vid->filter_target.replaced && (frame == vid->filter_target.replaced)) {
+         frame = vid->filter_target.written;
+         pitch = vid->filter_target.written_pitch;
+      }
       /* Update video mode if width/height have changed */
       if (unlikely( (vid->content_width  != width ) ||
                     (vid->content_height != height) )) {
          sdl_miyoomini_set_output(vid, width, height, vid->rgb32);
+         skip_ok = false;
       }
-      /* WaitAllDone to make sure the most recent frame is drawn complete */
-      MI_GFX_WaitAllDone(FALSE, flipFence);
-      /* SW Blit frame to GFX surface with scaling */
-      vid->scale_func(vid, (void*)frame, vid->screen->pixels, width, height, pitch, vid->screen->pitch);
-      /* HW Blit GFX surface to Framebuffer and Flip */
-      GFX_UpdateRect(vid->screen, vid->video_x, vid->video_y, vid->video_w, vid->video_h);
+      sdl_miyoomini_thermal_frame(vid);
+      /* Next direct buffer to hand to the core */
+      for (uint32_t i = 0; i < DIRECT_RING; i++)
+         if (vid->direct[i] && (frame == vid->direct[i]->pixels)) vid->direct_idx = (i + 1) % DIRECT_RING;
+      if (vid->presenter) sdl_miyoomini_present_submit(vid, frame, width, height, pitch, skip_ok);
+      else sdl_miyoomini_present(vid, frame, width, height, pitch, skip_ok);
+      miyoo_thread_policy_frame();
+      miyoo_fault_stats_frame();
+      sdl_miyoomini_dvfs_frame(video_info->input_driver_nonblock_state);
+      sdl_miyoomini_filter_target_next(vid);
    } else {
+      sdl_miyoomini_present_drain(vid);
       if (!vid->was_in_menu) {
          vid->was_in_menu = true;
+         vid->menu_dirty = true;
          stOpt.eRotate = E_MI_GFX_ROTATE_180;
       }
-      SDL_SoftStretch(vid->menuscreen_rgui, NULL, vid->menuscreen, rgui_menu_stretch ? NULL : &rgui_menu_dest_rect);
-      GFX_Flip(vid->menuscreen);
+      /* Skip if neither menu texture nor OSD text has changed,
+       * keep 60Hz pacing instead of blocking flip */
+      if (!vid->menu_dirty && !msg && !vid->menu_osd) {
+         retro_time_t elapsed = cpu_features_get_time_usec() - vid->menu_frame_time;
+         if (vid->vsync && (elapsed >= 0) && (elapsed < 16667)) usleep(16667 - elapsed);
+         vid->menu_frame_time = cpu_features_get_time_usec();
+         return true;
+      }
+      vid->menu_frame_time = cpu_features_get_time_usec();
+      vid->menu_dirty = false;
+      vid->menu_osd = msg ? true : false;
+      /* HW Blit RGUI surface to Framebuffer with scaling and Flip */
+      if (rgui_menu_stretch) GFX_Flip(vid->menuscreen_rgui);
+      else GFX_UpdateRect(vid->menuscreen_rgui, rgui_menu_dest_rect.x, rgui_menu_dest_rect.y,
+            rgui_menu_dest_rect.w, rgui_menu_dest_rect.h);
    }
    return true;
 }
@@ -968,15 +2111,19 @@ static void sdl_miyoomini_set_texture_enable(void *data, bool state, bool full_s
 
    if (state == vid->menu_active) return;
    vid->menu_active = state;
+   sdl_miyoomini_ff_video_restore(vid);
 
    sdl_miyoomini_toggle_powersave(state);
 
    if (state) {
-      system("playActivity stop_all &");
+      static const char *const argv[] = { "playActivity", "stop_all", NULL };
+      miyoo_spawn(argv, NULL, NULL);
       vid->was_in_menu = true;
+      vid->menu_dirty = true;
    }
    else {
-      system("playActivity resume &");
+      static const char *const argv[] = { "playActivity", "resume", NULL };
+      miyoo_spawn(argv, NULL, NULL);
    }
 }
 
@@ -986,8 +2133,27 @@ static void sdl_miyoomini_set_texture_frame(void *data, const void *frame, bool
 
    if (unlikely( !vid || rgb32 || (width != RGUI_MENU_WIDTH) || (height != RGUI_MENU_HEIGHT))) return;
 
-   memcpy_neon(vid->menuscreen_rgui->pixels, (void*)frame,
-      RGUI_MENU_WIDTH * RGUI_MENU_HEIGHT * sizeof(uint16_t));
+   /* Copy only the rows that differ from the last copy kept in menuscreen_rgui,
+    * nothing when the menu texture has not changed */
+   const uint8_t *src = (const uint8_t*)frame;
+   uint8_t *dst       = (uint8_t*)vid->menuscreen_rgui->pixels;
+   uint32_t pitch     = vid->menuscreen_rgui->pitch;
+   uint32_t row_bytes = RGUI_MENU_WIDTH * sizeof(uint16_t);
+   unsigned first, last;
+
+   for (first = 0; first < RGUI_MENU_HEIGHT; first++)
+      if (memcmp(dst + first * pitch, src + first * row_bytes, row_bytes)) break;
+   if (first == RGUI_MENU_HEIGHT) return;
+   for (last = RGUI_MENU_HEIGHT - 1; last > first; last--)
+      if (memcmp(dst + last * pitch, src + last * row_bytes, row_bytes)) break;
+   vid->menu_dirty = true;
+
+   /* WaitAllDone to make sure the recent blit from the surface is complete */
+   MI_GFX_WaitAllDone(FALSE, flipFence);
+   if (pitch == row_bytes)
+      memcpy_neon(dst + first * pitch, (void*)(src + first * row_bytes), (last - first + 1) * row_bytes);
+   else for (; first <= last; first++)
+      memcpy_neon(dst + first * pitch, (void*)(src + first * row_bytes), row_bytes);
 }
 
 static void sdl_miyoomini_gfx_set_nonblock_state(void *data, bool toggle,
@@ -997,6 +2163,9 @@ static void sdl_miyoomini_gfx_set_nonblock_state(void *data, bool toggle,
 
    bool vsync            = !toggle;
 
+   /* Fast forward toggled */
+   sdl_miyoomini_ff_video_restore(vid);
+
    /* Check whether vsync status has changed */
    if (vid->vsync != vsync)
    {
@@ -1028,13 +2197,46 @@ static bool sdl_miyoomini_gfx_alive(void *data) {
    return !vid->quitting;
 }
 
-static bool sdl_miyoomini_gfx_focus(void *data) { return true; }
+/* Polled by the runloop before the core runs. While fast forwarding, predict
+ * whether the next frame will be dropped by sdl_miyoomini_gfx_frame
+ * (ff_frame_time_min) and if so, report video disabled via
+ * RETRO_ENVIRONMENT_GET_AUDIO_VIDEO_ENABLE (miyoo_video_skip) so that cores
+ * honouring it can skip rendering. VIDEO_FLAG_ACTIVE is left alone, frame()
+ * still runs and drops the prediction if focus is not polled again */
+static bool sdl_miyoomini_gfx_focus(void *data) {
+   sdl_miyoomini_video_t *vid = (sdl_miyoomini_video_t*)data;
+   if (unlikely(!vid)) return true;
+
+   runloop_state_t *runloop_st    = runloop_state_get_ptr();
+
+   if (unlikely((runloop_st->flags & RUNLOOP_FLAG_FASTMOTION) && !vid->menu_active)) {
+      retro_time_t current_time = cpu_features_get_time_usec();
+      retro_time_t iter_time    = current_time - vid->ff_iter_time;
+      vid->ff_iter_time = current_time;
+      if (iter_time < vid->ff_frame_time_min) {
+         /* EMA of iteration time, 1/8 */
+         vid->ff_iter_avg += (iter_time - vid->ff_iter_avg) >> 3;
+         /* The frame of this iteration is expected at current_time + ff_iter_avg */
+         bool drop = (current_time + vid->ff_iter_avg - vid->last_frame_time) < vid->ff_frame_time_min;
+         if (drop && !vid->ff_video_off) {
+            miyoo_video_skip_set(true);
+            vid->ff_video_off = true;
+         } else if (!drop) sdl_miyoomini_ff_video_restore(vid);
+         return true;
+      }
+   }
+   /* Not fast forwarding or stalled, always restore */
+   sdl_miyoomini_ff_video_restore(vid);
+   vid->ff_iter_time = cpu_features_get_time_usec();
+   return true;
+}
 static bool sdl_miyoomini_gfx_suppress_screensaver(void *data, bool enable) { return false; }
 static bool sdl_miyoomini_gfx_has_windowed(void *data) { return false; }
 
 static void sdl_miyoomini_gfx_set_rotation(void *data, unsigned rotation) {
    sdl_miyoomini_video_t *vid = (sdl_miyoomini_video_t*)data;
    if (unlikely(!vid)) return;
+   sdl_miyoomini_present_drain(vid);
    switch (rotation) {
       case 1:
          stOpt.eRotate = E_MI_GFX_ROTATE_90; break;
@@ -1055,9 +2257,69 @@ static void sdl_miyoomini_gfx_viewport_info(void *data, struct video_viewport *v
    sdl_miyoomini_video_t *vid = (sdl_miyoomini_video_t*)data;
    if (unlikely(!vid)) return;
 
+   /* upright size, as captured by read_viewport */
+   unsigned width  = (vid->rotate & 1) ? vid->content_height : vid->content_width;
+   unsigned height = (vid->rotate & 1) ? vid->content_width : vid->content_height;
+
+   /* savestate thumbnail, downscaled to fit CAPTURE_THUMB_* keeping the aspect */
+   if (miyoo_thumbnail_capture()) {
+      if (width > CAPTURE_THUMB_WIDTH) {
+         height = height * CAPTURE_THUMB_WIDTH / width;
+         width  = CAPTURE_THUMB_WIDTH;
+      }
+      if (height > CAPTURE_THUMB_HEIGHT) {
+         width  = width * CAPTURE_THUMB_HEIGHT / height;
+         height = CAPTURE_THUMB_HEIGHT;
+      }
+      if (!width) width = 1;
+      if (!height) height = 1;
+   }
+   vid->capture_width  = width;
+   vid->capture_height = height;
+
    vp->x = vp->y = 0;
-   vp->width  = vp->full_width  = vid->content_width;
-   vp->height = vp->full_height = vid->content_height;
+   vp->width  = vp->full_width  = width;
+   vp->height = vp->full_height = height;
+}
+
+/* Screenshot / savestate thumbnail capture, BGR24 bottom-up at the size reported by
+ * the last viewport_info (upright content size, or thumbnail size for savestates).
+ * The last frame is scaled down and rotated like on screen by one HW blit into a
+ * pooled surface, so only the small 32 -> 24bpp pack (rows read bottom-up) is left
+ * for the CPU, and is_idle makes no difference here.
+ * PNG encoding runs in the screenshot task of RetroArch. */
+static bool sdl_miyoomini_gfx_read_viewport(void *data, uint8_t *buffer, bool is_idle) {
+   sdl_miyoomini_video_t *vid = (sdl_miyoomini_video_t*)data;
+   if (unlikely(!vid || !vid->screen || !buffer)) return false;
+
+   /* screen is rotated 180 degrees, the upright rotation is the opposite one */
+   uint32_t rotate = vid->rotate ^ 2;
+   unsigned width  = vid->capture_width;
+   unsigned height = vid->capture_height;
+   if (unlikely(!width || !height)) {
+      width  = (rotate & 1) ? vid->content_height : vid->content_width;
+      height = (rotate & 1) ? vid->content_width : vid->content_height;
+   }
+
+   if (!vid->capture || (vid->capture->w != width) || (vid->capture->h != height)) {
+      if (vid->capture) GFX_FreeSurface(vid->capture);
+      vid->capture = GFX_CreateRGBSurface(0, width, height, 32, 0, 0, 0, 0);
+      if (unlikely(!vid->capture)) return false;
+   }
+   /* last frame may be in the direct buffer handed to the core */
+   sdl_miyoomini_present_drain(vid);
+   GFX_BlitSurfaceRotate(vid->shown ? vid->shown : vid->screen, NULL, vid->capture, NULL, rotate);
+
+   for (unsigned y = height; y-- > 0; ) {
+      const uint32_t *src = (const uint32_t*)((uint8_t*)vid->capture->pixels + y * vid->capture->pitch);
+      for (unsigned x = 0; x < width; x++) {
+         uint32_t pix = *src++;
+         *buffer++ = pix;
+         *buffer++ = pix >> 8;
+         *buffer++ = pix >> 16;
+      }
+   }
+   return true;
 }
 
 static float sdl_miyoomini_get_refresh_rate(void *data) { return 60.0f; }
@@ -1099,18 +2361,64 @@ static void sdl_miyoomini_apply_state_changes(void *data) {
    }
 }
 
+static void sdl_miyoomini_set_video_mode(void *data, unsigned width, unsigned height, bool fullscreen) {
+   sdl_miyoomini_video_t *vid = (sdl_miyoomini_video_t*)data;
+   if (unlikely(!vid)) return;
+
+   if ((width == SDL_MIYOOMINI_WIDTH && height == SDL_MIYOOMINI_HEIGHT) ||
+       (vid->new_res_available && width == NEW_RES_WIDTH && height == NEW_RES_HEIGHT))
+      sdl_miyoomini_set_resolution(vid, width, height);
+}
+
+static void sdl_miyoomini_get_video_output_size(void *data, unsigned *width, unsigned *height, char *desc, size_t desc_len) {
+   if (width)  *width  = res_x;
+   if (height) *height = res_y;
+   if (desc) snprintf(desc, desc_len, "%ux%u", res_x, res_y);
+}
+
+/* Only two modes, prev/next both toggle */
+static void sdl_miyoomini_get_video_output_next(void *data) {
+   sdl_miyoomini_video_t *vid = (sdl_miyoomini_video_t*)data;
+   if (unlikely(!vid) || !vid->new_res_available) return;
+
+   if (res_x == SDL_MIYOOMINI_WIDTH) sdl_miyoomini_set_resolution(vid, NEW_RES_WIDTH, NEW_RES_HEIGHT);
+   else sdl_miyoomini_set_resolution(vid, SDL_MIYOOMINI_WIDTH, SDL_MIYOOMINI_HEIGHT);
+}
+
 static uint32_t sdl_miyoomini_get_flags(void *data) { return 0; }
 
+/* Hand cores a GFX surface from a ring of DIRECT_RING buffers. When the frame is scaled
+ * by HW only it is blitted to the framebuffer without any CPU pass, with the presenter
+ * thread the frame is handed over without a copy for any layout */
+static bool sdl_miyoomini_get_current_software_framebuffer(void *data, struct retro_framebuffer *framebuffer) {
+   sdl_miyoomini_video_t *vid = (sdl_miyoomini_video_t*)data;
+
+   /* previous contents are in another buffer, read access is not supported,
+    * the ring is the softfilter output when a filter is attached */
+   if (unlikely(!vid || !framebuffer || vid->menu_active || (!vid->direct_ok && !vid->presenter) ||
+         vid->filter_set || (framebuffer->access_flags & RETRO_MEMORY_ACCESS_READ) ||
+         (framebuffer->width != vid->content_width) || (framebuffer->height != vid->content_height))) return false;
+
+   SDL_Surface *direct = sdl_miyoomini_direct_next(vid);
+   if (unlikely(!direct)) return false;
+
+   framebuffer->data         = direct->pixels;
+   framebuffer->pitch        = direct->pitch;
+   framebuffer->format       = vid->rgb32 ? RETRO_PIXEL_FORMAT_XRGB8888 : RETRO_PIXEL_FORMAT_RGB565;
+   framebuffer->memory_flags = RETRO_MEMORY_TYPE_CACHED;
+   return true;
+}
+
 static const video_poke_interface_t sdl_miyoomini_poke_interface = {
    sdl_miyoomini_get_flags,
    NULL, /* load_texture */
    NULL, /* unload_texture */
-   NULL, /* set_video_mode */
+   sdl_miyoomini_set_video_mode,
    sdl_miyoomini_get_refresh_rate,
    sdl_miyoomini_set_filtering,
-   NULL, /* get_video_output_size */
-   NULL, /* get_video_output_prev */
-   NULL, /* get_video_output_next */
+   sdl_miyoomini_get_video_output_size,
+   sdl_miyoomini_get_video_output_next, /* get_video_output_prev */
+   sdl_miyoomini_get_video_output_next,
    NULL, /* get_current_framebuffer */
    NULL, /* get_proc_address */
    NULL, /* set_aspect_ratio */
@@ -1121,7 +2429,7 @@ static const video_poke_interface_t sdl_miyoomini_poke_interface = {
    NULL, /* sdl_show_mouse */
    NULL, /* sdl_grab_mouse_toggle */
    NULL, /* get_current_shader */
-   NULL, /* get_current_software_framebuffer */
+   sdl_miyoomini_get_current_software_framebuffer,
    NULL, /* get_hw_render_interface */
    NULL, /* set_hdr_max_nits */
    NULL, /* set_hdr_paper_white_nits */
@@ -1142,50 +2450,83 @@ static void sdl_miyoomini_overlay_enable(void *data, bool state) {
 	sdl_miyoomini_video_t *vid = (sdl_miyoomini_video_t *)data;
 	if (!vid) return;
 
+	vid->overlay_enabled = state;
 	if ((state)&&(vid->overlay_surface)) GFX_SetupOverlaySurface(vid->overlay_surface);
 	else GFX_SetupOverlaySurface(NULL);
 }
 
 static bool sdl_miyoomini_overlay_load(void *data, const void *image_data, unsigned num_images) {
 	sdl_miyoomini_video_t *vid = (sdl_miyoomini_video_t *)data;
-	if (!vid) return false;
+	if ((!vid)||(!num_images)) return false;
 
 	struct texture_image *images = (struct texture_image *)image_data;
-	void* pixels = images[0].pixels;
-	uint32_t width = images[0].width;
-	uint32_t height = images[0].height;
+	settings_t *settings = config_get_ptr();
+	uint8_t alpha = (settings) ? settings->floats.input_overlay_opacity * 0xFF : 255;
+
+	GFX_SetupOverlaySurface(NULL);
+	sdl_miyoomini_overlay_free_images(vid);
+	if (vid->overlay_surface) { GFX_FreeSurface(vid->overlay_surface); vid->overlay_surface = NULL; }
+
+	vid->overlay_images = (sdl_miyoomini_overlay_image_t *)calloc(num_images, sizeof(sdl_miyoomini_overlay_image_t));
+	if (!vid->overlay_images) return false;
+	vid->overlay_count = num_images;
+
+	for (unsigned i = 0; i < num_images; i++) {
+		sdl_miyoomini_overlay_image_t *img = &vid->overlay_images[i];
+		if (images[i].pixels) {
+			SDL_Surface *ostmp = SDL_CreateRGBSurfaceFrom(images[i].pixels, images[i].width, images[i].height, 32,
+						images[i].width*4, 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
+			img->surface = GFX_DuplicateSurface(ostmp);
+			SDL_FreeSurface(ostmp);
+		}
+		/* full screen until vertex_geom is set */
+		img->w = img->h = 1.0f;
+		img->alpha = alpha;
+	}
 
-	if (vid->overlay_surface) GFX_FreeSurface(vid->overlay_surface);
-	SDL_Surface *ostmp = SDL_CreateRGBSurfaceFrom(pixels, width, height, 32, width*4,
-				0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
-	SDL_Surface *ostmp2 = GFX_DuplicateSurface(ostmp);
-	SDL_FreeSurface(ostmp);
 	vid->overlay_surface = GFX_CreateRGBSurface(0, res_x, res_y, 32,
 				0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
-	ostmp2->flags &= ~SDL_SRCALPHA;
-	GFX_BlitSurfaceRotate(ostmp2, NULL, vid->overlay_surface, NULL, 2);
-	GFX_FreeSurface(ostmp2);
-
-	settings_t *settings = config_get_ptr();
+	if (!vid->overlay_surface) { sdl_miyoomini_overlay_free_images(vid); return false; }
 	vid->overlay_surface->flags |= SDL_SRCALPHA;
-	vid->overlay_surface->format->alpha = (settings) ? settings->floats.input_overlay_opacity * 0xFF : 255;
-	GFX_SetupOverlaySurface(vid->overlay_surface);
+	vid->overlay_surface->format->alpha = alpha;
+	vid->overlay_enabled = true;
+	sdl_miyoomini_overlay_compose(vid);
 
 	return true;
 }
 
 static void sdl_miyoomini_overlay_tex_geom(void *data, unsigned idx, float x, float y, float w, float h) { }
-static void sdl_miyoomini_overlay_vertex_geom(void *data, unsigned idx, float x, float y, float w, float h) { }
+
+static void sdl_miyoomini_overlay_vertex_geom(void *data, unsigned idx, float x, float y, float w, float h) {
+	sdl_miyoomini_video_t *vid = (sdl_miyoomini_video_t *)data;
+	if ((!vid)||(idx >= vid->overlay_count)) return;
+
+	sdl_miyoomini_overlay_image_t *img = &vid->overlay_images[idx];
+	if ((img->x != x)||(img->y != y)||(img->w != w)||(img->h != h)) {
+		img->x = x; img->y = y; img->w = w; img->h = h;
+		vid->overlay_dirty = true;
+	}
+}
+
 static void sdl_miyoomini_overlay_full_screen(void *data, bool enable) { }
 
 static void sdl_miyoomini_overlay_set_alpha(void *data, unsigned idx, float mod) {
 	sdl_miyoomini_video_t *vid = (sdl_miyoomini_video_t *)data;
-	if ((!idx)&&(vid)&&(vid->overlay_surface)) {
-		uint8_t value = mod * 0xFF;
+	if ((!vid)||(!vid->overlay_surface)||(idx >= vid->overlay_count)) return;
+
+	uint8_t value = mod * 0xFF;
+	if (!idx) {
 		if (!(vid->overlay_surface->flags & SDL_SRCALPHA)||(vid->overlay_surface->format->alpha != value)) {
+			vid->overlay_surface->flags |= SDL_SRCALPHA;
 			vid->overlay_surface->format->alpha = value;
-			GFX_SetupOverlaySurface(vid->overlay_surface);
+			vid->overlay_images[0].alpha = value;
+			/* alpha of other images is relative to image 0 */
+			if (vid->overlay_count > 1) vid->overlay_dirty = true;
+			else if (vid->overlay_enabled) GFX_SetupOverlaySurface(vid->overlay_surface);
 		}
+	} else if (vid->overlay_images[idx].alpha != value) {
+		vid->overlay_images[idx].alpha = value;
+		vid->overlay_dirty = true;
 	}
 	return;
 }
@@ -1222,7 +2563,7 @@ video_driver_t video_sdl_dingux = {
    NULL, /* set_viewport */
    sdl_miyoomini_gfx_set_rotation,
    sdl_miyoomini_gfx_viewport_info,
-   NULL, /* read_viewport  */
+   sdl_miyoomini_gfx_read_viewport,
    NULL, /* read_frame_raw */
 #ifdef HAVE_OVERLAY
    sdl_miyoomini_gfx_get_overlay_interface,
@@ -0,0 +1,40 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __SOFTFILTER_TARGET_H
+#define __SOFTFILTER_TARGET_H
+
+#include <stddef.h>
+
+/* Output buffer offered by the video driver (miyoomini: a GFX surface),
+ * filters render into it instead of the frontend buffer when it has
+ * exactly the output size, so the driver can show it without a copy */
+struct softfilter_output_target
+{
+   /* set by the driver, data = NULL disables the redirection */
+   void *data;
+   size_t pitch;
+   unsigned width;
+   unsigned height;
+   /* set by the filter on each run, replaced = NULL when not redirected */
+   const void *replaced;
+   void *written;
+   size_t written_pitch;
+};
+
+/* Exported by the filter libraries, NULL detaches the target */
+#define SOFTFILTER_SET_OUTPUT_TARGET_SYM "softfilter_set_output_target"
+typedef void (*softfilter_set_output_target_t)(struct softfilter_output_target *target);
+
+#endif
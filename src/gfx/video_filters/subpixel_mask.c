@@ -0,0 +1,605 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2018 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Compile: gcc -o subpixel_mask.so -shared subpixel_mask.c -std=c99 -O3 -Wall -pedantic -fPIC */
+
+/* Scales each pixel to an NxN block, every output pixel of the block keeps only
+ * the channels given by the mask in the .filt config:
+ *
+ *    filter = subpixel_mask
+ *    subpixel_mask_scale = 3
+ *    subpixel_mask_row0 = "R G -"
+ *    subpixel_mask_row1 = "R G B"
+ *    subpixel_mask_row2 = "- - B"
+ *
+ * scale is 2 .. 4 and the block is always square, the same scale is used for
+ * both axes (no 2x3 or 3x2 masks, the row kernels widen by the row count).
+ * rowN has one cell per output column made of R, G, B
+ * ("RGB" keeps the pixel, "-" is black). Missing rows or cells keep the pixel.
+ * An optional brightnessN = "100 50 100" sets the brightness in percent per cell,
+ * each channel is scaled by round(percent * 256 / 100) / 256 (50 halves exactly).
+ */
+
+#include "softfilter.h"
+#include "softfilter_target.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __ARM_NEON__
+#include <arm_neon.h>
+#endif
+
+#ifdef RARCH_INTERNAL
+#define softfilter_get_implementation subpixel_mask_get_implementation
+#define softfilter_thread_data subpixel_mask_softfilter_thread_data
+#define filter_data subpixel_mask_filter_data
+#define output_target subpixel_mask_output_target
+#define softfilter_set_output_target subpixel_mask_set_output_target
+#endif
+
+#define SUBPIXEL_MASK_SCALE_MIN 2
+#define SUBPIXEL_MASK_SCALE_MAX 4
+
+struct softfilter_thread_data
+{
+   void *out_data;
+   const void *in_data;
+   size_t out_pitch;
+   size_t in_pitch;
+   unsigned colfmt;
+   unsigned width;
+   unsigned height;
+   int first;
+   int last;
+};
+
+#define SUBPIXEL_MASK_LEVEL_FULL 256
+
+/* One output row of the block, out = dim(pix, level) & mask per cell */
+struct subpixel_mask_row
+{
+   uint32_t mask[SUBPIXEL_MASK_SCALE_MAX];
+   uint32_t level[SUBPIXEL_MASK_SCALE_MAX];   /* brightness, SUBPIXEL_MASK_LEVEL_FULL = as is */
+   int dim;    /* any cell is dimmed */
+   int same;   /* same as the row above, copied */
+};
+
+typedef void (*subpixel_mask_row_t)(const void* __restrict src, void* __restrict dst,
+      uint32_t sw, const struct subpixel_mask_row *row, unsigned scale);
+
+struct filter_data
+{
+   unsigned threads;
+   struct softfilter_thread_data *workers;
+   unsigned in_fmt;
+   unsigned neon;
+   unsigned scale;
+   struct subpixel_mask_row rows[SUBPIXEL_MASK_SCALE_MAX];
+   subpixel_mask_row_t row_func;
+};
+
+/* Driver surface to render into, see softfilter_target.h */
+static struct softfilter_output_target *output_target;
+
+static unsigned subpixel_mask_generic_input_fmts(void)
+{
+   return SOFTFILTER_FMT_XRGB8888 | SOFTFILTER_FMT_RGB565;
+}
+
+static unsigned subpixel_mask_generic_output_fmts(unsigned input_fmts)
+{
+   return input_fmts;
+}
+
+static unsigned subpixel_mask_generic_threads(void *data)
+{
+   struct filter_data *filt = (struct filter_data*)data;
+   return filt->threads;
+}
+
+//
+//	Mask config, cells are parsed to a channel mask and a brightness level
+//
+static uint32_t subpixel_mask_channels(const char *cell, size_t len, unsigned in_fmt)
+{
+   int rgb565 = (in_fmt == SOFTFILTER_FMT_RGB565);
+   uint32_t mask = 0;
+   size_t i;
+
+   for (i = 0; i < len; i++) {
+      switch (cell[i]) {
+         case 'R': case 'r': mask |= rgb565 ? 0xF800 : 0x00FF0000; break;
+         case 'G': case 'g': mask |= rgb565 ? 0x07E0 : 0x0000FF00; break;
+         case 'B': case 'b': mask |= rgb565 ? 0x001F : 0x000000FF; break;
+         default: break;
+      }
+   }
+   /* whole pixel is copied as is */
+   if (!rgb565 && (mask == 0x00FFFFFF)) {
+      mask = 0xFFFFFFFF;
+   }
+   return mask;
+}
+
+static void subpixel_mask_parse_row(struct subpixel_mask_row *row, const char *cells,
+      const int *brightness, unsigned num_brightness, unsigned scale, unsigned in_fmt)
+{
+   uint32_t all = subpixel_mask_channels("RGB", 3, in_fmt);
+   int rgb565 = (in_fmt == SOFTFILTER_FMT_RGB565);
+   const char *p = cells;
+   unsigned c;
+
+   for (c = 0; c < scale; c++) {
+      size_t len = 0;
+      int percent = (c < num_brightness) ? brightness[c] : 100;
+
+      row->mask[c] = all;
+      row->level[c] = SUBPIXEL_MASK_LEVEL_FULL;
+      while (p && (*p == ' ' || *p == '\t' || *p == ',')) {
+         p++;
+      }
+      if (p && *p) {
+         while (p[len] && p[len] != ' ' && p[len] != '\t' && p[len] != ',') {
+            len++;
+         }
+         row->mask[c] = subpixel_mask_channels(p, len, in_fmt);
+         p += len;
+      }
+      if (percent <= 0) {
+         row->mask[c] = 0;
+      } else if (percent < 100) {
+         row->level[c] = (percent * SUBPIXEL_MASK_LEVEL_FULL + 50) / 100;
+         /* X byte of a dimmed XRGB8888 cell is cleared */
+         row->mask[c] &= rgb565 ? 0xFFFF : 0x00FFFFFF;
+         row->dim = 1;
+      }
+   }
+}
+
+static void subpixel_mask_load(struct filter_data *filt,
+      const struct softfilter_config *config, void *userdata)
+{
+   unsigned r, c;
+   int scale = 3;
+
+   if (config) {
+      config->get_int(userdata, "scale", &scale, 3);
+   }
+   if (scale < SUBPIXEL_MASK_SCALE_MIN) {
+      scale = SUBPIXEL_MASK_SCALE_MIN;
+   } else if (scale > SUBPIXEL_MASK_SCALE_MAX) {
+      scale = SUBPIXEL_MASK_SCALE_MAX;
+   }
+   filt->scale = scale;
+
+   for (r = 0; r < filt->scale; r++) {
+      struct subpixel_mask_row *row = &filt->rows[r];
+      char *cells = NULL;
+      int *brightness = NULL;
+      unsigned num_brightness = 0;
+      char key[32];
+
+      if (config) {
+         snprintf(key, sizeof(key), "row%u", r);
+         config->get_string(userdata, key, &cells, "");
+         snprintf(key, sizeof(key), "brightness%u", r);
+         config->get_int_array(userdata, key, &brightness, &num_brightness, NULL, 0);
+      }
+      subpixel_mask_parse_row(row, cells, brightness, num_brightness, filt->scale, filt->in_fmt);
+      if (config) {
+         config->free(cells);
+         config->free(brightness);
+      }
+
+      row->same = (r > 0);
+      for (c = 0; c < filt->scale && row->same; c++) {
+         row->same = (row->mask[c] == filt->rows[r-1].mask[c]) && (row->level[c] == filt->rows[r-1].level[c]);
+      }
+   }
+}
+
+//
+//	Channels scaled by level / 256, same result as the NEON versions
+//
+static inline uint16_t subpixel_mask_dim16(uint32_t pix, uint32_t level) {
+	return ((((pix >> 11) * level) >> 8) << 11) | (((((pix >> 5) & 0x3F) * level) >> 8) << 5) |
+	       (((pix & 0x1F) * level) >> 8);
+}
+
+static inline uint32_t subpixel_mask_dim32(uint32_t pix, uint32_t level) {
+	if (level >= SUBPIXEL_MASK_LEVEL_FULL) return pix;
+	return ((((pix & 0x00FF00FF) * level) >> 8) & 0x00FF00FF) | ((((pix & 0x0000FF00) * level) >> 8) & 0x0000FF00);
+}
+
+//
+//	C versions, one loop per scale for rows without dimmed cells
+//
+static void subpixel_mask_row_c16(const void* __restrict src, void* __restrict dst,
+      uint32_t sw, const struct subpixel_mask_row *row, unsigned scale) {
+	const uint16_t *s = (const uint16_t*)src;
+	uint16_t *d = (uint16_t*)dst;
+	uint32_t x, c;
+	if (row->dim) {
+		for (x=0; x<sw; x++, d+=scale) {
+			uint16_t pix = s[x];
+			for (c=0; c<scale; c++) { d[c] = subpixel_mask_dim16(pix, row->level[c]) & row->mask[c]; }
+		}
+	} else if (scale == 2) {
+		const uint16_t m0 = row->mask[0], m1 = row->mask[1];
+		for (x=0; x<sw; x++, d+=2) { uint16_t pix = s[x]; d[0] = pix & m0; d[1] = pix & m1; }
+	} else if (scale == 3) {
+		const uint16_t m0 = row->mask[0], m1 = row->mask[1], m2 = row->mask[2];
+		for (x=0; x<sw; x++, d+=3) { uint16_t pix = s[x]; d[0] = pix & m0; d[1] = pix & m1; d[2] = pix & m2; }
+	} else {
+		const uint16_t m0 = row->mask[0], m1 = row->mask[1], m2 = row->mask[2], m3 = row->mask[3];
+		for (x=0; x<sw; x++, d+=4) { uint16_t pix = s[x]; d[0] = pix & m0; d[1] = pix & m1; d[2] = pix & m2; d[3] = pix & m3; }
+	}
+}
+
+static void subpixel_mask_row_c32(const void* __restrict src, void* __restrict dst,
+      uint32_t sw, const struct subpixel_mask_row *row, unsigned scale) {
+	const uint32_t *s = (const uint32_t*)src;
+	uint32_t *d = (uint32_t*)dst;
+	uint32_t x, c;
+	if (row->dim) {
+		for (x=0; x<sw; x++, d+=scale) {
+			uint32_t pix = s[x];
+			for (c=0; c<scale; c++) { d[c] = subpixel_mask_dim32(pix, row->level[c]) & row->mask[c]; }
+		}
+	} else if (scale == 2) {
+		const uint32_t m0 = row->mask[0], m1 = row->mask[1];
+		for (x=0; x<sw; x++, d+=2) { uint32_t pix = s[x]; d[0] = pix & m0; d[1] = pix & m1; }
+	} else if (scale == 3) {
+		const uint32_t m0 = row->mask[0], m1 = row->mask[1], m2 = row->mask[2];
+		for (x=0; x<sw; x++, d+=3) { uint32_t pix = s[x]; d[0] = pix & m0; d[1] = pix & m1; d[2] = pix & m2; }
+	} else {
+		const uint32_t m0 = row->mask[0], m1 = row->mask[1], m2 = row->mask[2], m3 = row->mask[3];
+		for (x=0; x<sw; x++, d+=4) { uint32_t pix = s[x]; d[0] = pix & m0; d[1] = pix & m1; d[2] = pix & m2; d[3] = pix & m3; }
+	}
+}
+
+#ifdef __ARM_NEON__
+//
+//	NEON versions, one loop per scale with interleaved stores, 8 (RGB565) / 4 (XRGB8888)
+//	pixels per loop, channel multiplies only for rows with dimmed cells, rest by C
+//
+static inline uint16x8_t subpixel_mask_dim_neon16(uint16x8_t p, uint16x8_t l) {
+	uint16x8_t r = vshrq_n_u16(vmulq_u16(vshrq_n_u16(p, 11), l), 8);
+	uint16x8_t g = vshrq_n_u16(vmulq_u16(vandq_u16(vshrq_n_u16(p, 5), vdupq_n_u16(0x3F)), l), 8);
+	uint16x8_t b = vshrq_n_u16(vmulq_u16(vandq_u16(p, vdupq_n_u16(0x1F)), l), 8);
+	return vorrq_u16(vorrq_u16(vshlq_n_u16(r, 11), vshlq_n_u16(g, 5)), b);
+}
+
+/* each byte * level >> 8, level 256 keeps the pixel (X byte included) */
+static inline uint32x4_t subpixel_mask_dim_neon32(uint32x4_t p, uint16x8_t l) {
+	uint8x16_t b = vreinterpretq_u8_u32(p);
+	uint16x8_t lo = vmulq_u16(vmovl_u8(vget_low_u8(b)), l);
+	uint16x8_t hi = vmulq_u16(vmovl_u8(vget_high_u8(b)), l);
+	return vreinterpretq_u32_u8(vcombine_u8(vshrn_n_u16(lo, 8), vshrn_n_u16(hi, 8)));
+}
+
+static void subpixel_mask_row2_neon16(const void* __restrict src, void* __restrict dst,
+      uint32_t sw, const struct subpixel_mask_row *row, unsigned scale) {
+	const uint16_t *s = (const uint16_t*)src;
+	uint16_t *d = (uint16_t*)dst;
+	uint32_t x = 0, n = sw & ~7;
+	const uint16x8_t m0 = vdupq_n_u16(row->mask[0]), m1 = vdupq_n_u16(row->mask[1]);
+	uint16x8x2_t o;
+	if (row->dim) {
+		const uint16x8_t l0 = vdupq_n_u16(row->level[0]), l1 = vdupq_n_u16(row->level[1]);
+		for (; x<n; x+=8, s+=8, d+=16) {
+			uint16x8_t p = vld1q_u16(s);
+			o.val[0] = vandq_u16(subpixel_mask_dim_neon16(p, l0), m0); o.val[1] = vandq_u16(subpixel_mask_dim_neon16(p, l1), m1);
+			vst2q_u16(d, o);
+		}
+	} else {
+		for (; x<n; x+=8, s+=8, d+=16) {
+			uint16x8_t p = vld1q_u16(s);
+			o.val[0] = vandq_u16(p, m0); o.val[1] = vandq_u16(p, m1);
+			vst2q_u16(d, o);
+		}
+	}
+	subpixel_mask_row_c16(s, d, sw - x, row, scale);
+}
+
+static void subpixel_mask_row3_neon16(const void* __restrict src, void* __restrict dst,
+      uint32_t sw, const struct subpixel_mask_row *row, unsigned scale) {
+	const uint16_t *s = (const uint16_t*)src;
+	uint16_t *d = (uint16_t*)dst;
+	uint32_t x = 0, n = sw & ~7;
+	const uint16x8_t m0 = vdupq_n_u16(row->mask[0]), m1 = vdupq_n_u16(row->mask[1]), m2 = vdupq_n_u16(row->mask[2]);
+	uint16x8x3_t o;
+	if (row->dim) {
+		const uint16x8_t l0 = vdupq_n_u16(row->level[0]), l1 = vdupq_n_u16(row->level[1]), l2 = vdupq_n_u16(row->level[2]);
+		for (; x<n; x+=8, s+=8, d+=24) {
+			uint16x8_t p = vld1q_u16(s);
+			o.val[0] = vandq_u16(subpixel_mask_dim_neon16(p, l0), m0); o.val[1] = vandq_u16(subpixel_mask_dim_neon16(p, l1), m1);
+			o.val[2] = vandq_u16(subpixel_mask_dim_neon16(p, l2), m2);
+			vst3q_u16(d, o);
+		}
+	} else {
+		for (; x<n; x+=8, s+=8, d+=24) {
+			uint16x8_t p = vld1q_u16(s);
+			o.val[0] = vandq_u16(p, m0); o.val[1] = vandq_u16(p, m1); o.val[2] = vandq_u16(p, m2);
+			vst3q_u16(d, o);
+		}
+	}
+	subpixel_mask_row_c16(s, d, sw - x, row, scale);
+}
+
+static void subpixel_mask_row4_neon16(const void* __restrict src, void* __restrict dst,
+      uint32_t sw, const struct subpixel_mask_row *row, unsigned scale) {
+	const uint16_t *s = (const uint16_t*)src;
+	uint16_t *d = (uint16_t*)dst;
+	uint32_t x = 0, n = sw & ~7;
+	const uint16x8_t m0 = vdupq_n_u16(row->mask[0]), m1 = vdupq_n_u16(row->mask[1]),
+	                 m2 = vdupq_n_u16(row->mask[2]), m3 = vdupq_n_u16(row->mask[3]);
+	uint16x8x4_t o;
+	if (row->dim) {
+		const uint16x8_t l0 = vdupq_n_u16(row->level[0]), l1 = vdupq_n_u16(row->level[1]),
+		                l2 = vdupq_n_u16(row->level[2]), l3 = vdupq_n_u16(row->level[3]);
+		for (; x<n; x+=8, s+=8, d+=32) {
+			uint16x8_t p = vld1q_u16(s);
+			o.val[0] = vandq_u16(subpixel_mask_dim_neon16(p, l0), m0); o.val[1] = vandq_u16(subpixel_mask_dim_neon16(p, l1), m1);
+			o.val[2] = vandq_u16(subpixel_mask_dim_neon16(p, l2), m2); o.val[3] = vandq_u16(subpixel_mask_dim_neon16(p, l3), m3);
+			vst4q_u16(d, o);
+		}
+	} else {
+		for (; x<n; x+=8, s+=8, d+=32) {
+			uint16x8_t p = vld1q_u16(s);
+			o.val[0] = vandq_u16(p, m0); o.val[1] = vandq_u16(p, m1);
+			o.val[2] = vandq_u16(p, m2); o.val[3] = vandq_u16(p, m3);
+			vst4q_u16(d, o);
+		}
+	}
+	subpixel_mask_row_c16(s, d, sw - x, row, scale);
+}
+
+static void subpixel_mask_row2_neon32(const void* __restrict src, void* __restrict dst,
+      uint32_t sw, const struct subpixel_mask_row *row, unsigned scale) {
+	const uint32_t *s = (const uint32_t*)src;
+	uint32_t *d = (uint32_t*)dst;
+	uint32_t x = 0, n = sw & ~3;
+	const uint32x4_t m0 = vdupq_n_u32(row->mask[0]), m1 = vdupq_n_u32(row->mask[1]);
+	uint32x4x2_t o;
+	if (row->dim) {
+		const uint16x8_t l0 = vdupq_n_u16(row->level[0]), l1 = vdupq_n_u16(row->level[1]);
+		for (; x<n; x+=4, s+=4, d+=8) {
+			uint32x4_t p = vld1q_u32(s);
+			o.val[0] = vandq_u32(subpixel_mask_dim_neon32(p, l0), m0); o.val[1] = vandq_u32(subpixel_mask_dim_neon32(p, l1), m1);
+			vst2q_u32(d, o);
+		}
+	} else {
+		for (; x<n; x+=4, s+=4, d+=8) {
+			uint32x4_t p = vld1q_u32(s);
+			o.val[0] = vandq_u32(p, m0); o.val[1] = vandq_u32(p, m1);
+			vst2q_u32(d, o);
+		}
+	}
+	subpixel_mask_row_c32(s, d, sw - x, row, scale);
+}
+
+static void subpixel_mask_row3_neon32(const void* __restrict src, void* __restrict dst,
+      uint32_t sw, const struct subpixel_mask_row *row, unsigned scale) {
+	const uint32_t *s = (const uint32_t*)src;
+	uint32_t *d = (uint32_t*)dst;
+	uint32_t x = 0, n = sw & ~3;
+	const uint32x4_t m0 = vdupq_n_u32(row->mask[0]), m1 = vdupq_n_u32(row->mask[1]), m2 = vdupq_n_u32(row->mask[2]);
+	uint32x4x3_t o;
+	if (row->dim) {
+		const uint16x8_t l0 = vdupq_n_u16(row->level[0]), l1 = vdupq_n_u16(row->level[1]), l2 = vdupq_n_u16(row->level[2]);
+		for (; x<n; x+=4, s+=4, d+=12) {
+			uint32x4_t p = vld1q_u32(s);
+			o.val[0] = vandq_u32(subpixel_mask_dim_neon32(p, l0), m0); o.val[1] = vandq_u32(subpixel_mask_dim_neon32(p, l1), m1);
+			o.val[2] = vandq_u32(subpixel_mask_dim_neon32(p, l2), m2);
+			vst3q_u32(d, o);
+		}
+	} else {
+		for (; x<n; x+=4, s+=4, d+=12) {
+			uint32x4_t p = vld1q_u32(s);
+			o.val[0] = vandq_u32(p, m0); o.val[1] = vandq_u32(p, m1); o.val[2] = vandq_u32(p, m2);
+			vst3q_u32(d, o);
+		}
+	}
+	subpixel_mask_row_c32(s, d, sw - x, row, scale);
+}
+
+static void subpixel_mask_row4_neon32(const void* __restrict src, void* __restrict dst,
+      uint32_t sw, const struct subpixel_mask_row *row, unsigned scale) {
+	const uint32_t *s = (const uint32_t*)src;
+	uint32_t *d = (uint32_t*)dst;
+	uint32_t x = 0, n = sw & ~3;
+	const uint32x4_t m0 = vdupq_n_u32(row->mask[0]), m1 = vdupq_n_u32(row->mask[1]),
+	                 m2 = vdupq_n_u32(row->mask[2]), m3 = vdupq_n_u32(row->mask[3]);
+	uint32x4x4_t o;
+	if (row->dim) {
+		const uint16x8_t l0 = vdupq_n_u16(row->level[0]), l1 = vdupq_n_u16(row->level[1]),
+		                l2 = vdupq_n_u16(row->level[2]), l3 = vdupq_n_u16(row->level[3]);
+		for (; x<n; x+=4, s+=4, d+=16) {
+			uint32x4_t p = vld1q_u32(s);
+			o.val[0] = vandq_u32(subpixel_mask_dim_neon32(p, l0), m0); o.val[1] = vandq_u32(subpixel_mask_dim_neon32(p, l1), m1);
+			o.val[2] = vandq_u32(subpixel_mask_dim_neon32(p, l2), m2); o.val[3] = vandq_u32(subpixel_mask_dim_neon32(p, l3), m3);
+			vst4q_u32(d, o);
+		}
+	} else {
+		for (; x<n; x+=4, s+=4, d+=16) {
+			uint32x4_t p = vld1q_u32(s);
+			o.val[0] = vandq_u32(p, m0); o.val[1] = vandq_u32(p, m1);
+			o.val[2] = vandq_u32(p, m2); o.val[3] = vandq_u32(p, m3);
+			vst4q_u32(d, o);
+		}
+	}
+	subpixel_mask_row_c32(s, d, sw - x, row, scale);
+}
+#endif
+
+static void *subpixel_mask_generic_create(const struct softfilter_config *config,
+      unsigned in_fmt, unsigned out_fmt,
+      unsigned max_width, unsigned max_height,
+      unsigned threads, softfilter_simd_mask_t simd, void *userdata)
+{
+   struct filter_data *filt = (struct filter_data*)calloc(1, sizeof(*filt));
+
+   if (!filt) {
+      return NULL;
+   }
+   /* Rows are independent, each thread filters a band of rows */
+   if (!threads) {
+      threads = 1;
+   }
+   filt->workers = (struct softfilter_thread_data*)calloc(threads, sizeof(struct softfilter_thread_data));
+   filt->threads = threads;
+   filt->in_fmt  = in_fmt;
+#ifdef __ARM_NEON__
+   filt->neon    = (simd & SOFTFILTER_SIMD_NEON) ? 1 : 0;
+#endif
+   if (!filt->workers) {
+      free(filt);
+      return NULL;
+   }
+   subpixel_mask_load(filt, config, userdata);
+
+   filt->row_func = (in_fmt == SOFTFILTER_FMT_RGB565) ? subpixel_mask_row_c16 : subpixel_mask_row_c32;
+#ifdef __ARM_NEON__
+   if (filt->neon) {
+      static const subpixel_mask_row_t neon16[] = {
+         subpixel_mask_row2_neon16, subpixel_mask_row3_neon16, subpixel_mask_row4_neon16 };
+      static const subpixel_mask_row_t neon32[] = {
+         subpixel_mask_row2_neon32, subpixel_mask_row3_neon32, subpixel_mask_row4_neon32 };
+      filt->row_func = (in_fmt == SOFTFILTER_FMT_RGB565) ?
+            neon16[filt->scale - SUBPIXEL_MASK_SCALE_MIN] : neon32[filt->scale - SUBPIXEL_MASK_SCALE_MIN];
+   }
+#endif
+   return filt;
+}
+
+static void subpixel_mask_generic_output(void *data,
+      unsigned *out_width, unsigned *out_height,
+      unsigned width, unsigned height)
+{
+   struct filter_data *filt = (struct filter_data*)data;
+   *out_width = width * filt->scale;
+   *out_height = height * filt->scale;
+}
+
+static void subpixel_mask_generic_destroy(void *data)
+{
+   struct filter_data *filt = (struct filter_data*)data;
+   if (!filt) {
+      return;
+   }
+   free(filt->workers);
+   free(filt);
+}
+
+static void subpixel_mask_work_cb(void *data, void *thread_data)
+{
+   struct filter_data *filt = (struct filter_data*)data;
+   struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
+   const uint8_t *src = (const uint8_t*)thr->in_data;
+   uint8_t *dst = (uint8_t*)thr->out_data;
+   size_t row_size = thr->width * filt->scale * ((filt->in_fmt == SOFTFILTER_FMT_RGB565) ? 2 : 4);
+   unsigned y, r;
+
+   for (y = 0; y < thr->height; y++, src += thr->in_pitch) {
+      for (r = 0; r < filt->scale; r++, dst += thr->out_pitch) {
+         if (filt->rows[r].same) {
+            memcpy(dst, dst - thr->out_pitch, row_size);
+         } else {
+            filt->row_func(src, dst, thr->width, &filt->rows[r], filt->scale);
+         }
+      }
+   }
+}
+
+static void subpixel_mask_generic_packets(void *data,
+      struct softfilter_work_packet *packets,
+      void *output, size_t output_stride,
+      const void *input, unsigned width, unsigned height, size_t input_stride)
+{
+   struct filter_data *filt = (struct filter_data*)data;
+   unsigned i;
+
+   /* Render into the driver's surface when it has exactly the output size */
+   if (output_target) {
+      unsigned out_width, out_height;
+      subpixel_mask_generic_output(data, &out_width, &out_height, width, height);
+      output_target->replaced = NULL;
+      if (output_target->data && (output_target->width == out_width) &&
+            (output_target->height == out_height)) {
+         output_target->replaced = output;
+         output_target->written = output_target->data;
+         output_target->written_pitch = output_target->pitch;
+         output = output_target->data;
+         output_stride = output_target->pitch;
+      }
+   }
+
+   /* Split into bands of rows, remainder of odd heights is spread over the bands */
+   for (i = 0; i < filt->threads; i++) {
+      struct softfilter_thread_data *thr = (struct softfilter_thread_data*)&filt->workers[i];
+      unsigned y_start = (height * i) / filt->threads;
+      unsigned y_end   = (height * (i + 1)) / filt->threads;
+
+      thr->out_data = (uint8_t*)output + y_start * filt->scale * output_stride;
+      thr->in_data = (const uint8_t*)input + y_start * input_stride;
+      thr->out_pitch = output_stride;
+      thr->in_pitch = input_stride;
+      thr->width = width;
+      thr->height = y_end - y_start;
+      thr->first = (i == 0);
+      thr->last = (i == filt->threads - 1);
+
+      packets[i].work = subpixel_mask_work_cb;
+      packets[i].thread_data = thr;
+   }
+}
+
+static const struct softfilter_implementation subpixel_mask_generic = {
+   subpixel_mask_generic_input_fmts,
+   subpixel_mask_generic_output_fmts,
+
+   subpixel_mask_generic_create,
+   subpixel_mask_generic_destroy,
+
+   subpixel_mask_generic_threads,
+   subpixel_mask_generic_output,
+   subpixel_mask_generic_packets,
+
+   SOFTFILTER_API_VERSION,
+   "Subpixel_mask",
+   "subpixel_mask",
+};
+
+const struct softfilter_implementation *softfilter_get_implementation(
+      softfilter_simd_mask_t simd)
+{
+   (void)simd;
+   return &subpixel_mask_generic;
+}
+
+void softfilter_set_output_target(struct softfilter_output_target *target)
+{
+   output_target = target;
+}
+
+#ifdef RARCH_INTERNAL
+#undef softfilter_get_implementation
+#undef softfilter_thread_data
+#undef filter_data
+#undef output_target
+#undef softfilter_set_output_target
+#endif
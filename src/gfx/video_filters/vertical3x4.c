@@ -17,6 +17,7 @@
 /* Compile: gcc -o vertical3x4.so -shared vertical3x4.c -std=c99 -O3 -Wall -pedantic -fPIC */
 
 #include "softfilter.h"
+#include "softfilter_target.h"
 #include <stdlib.h>
 #include <string.h>
 
@@ -24,6 +25,8 @@
 #define softfilter_get_implementation vertical3x4_get_implementation
 #define softfilter_thread_data vertical3x4_softfilter_thread_data
 #define filter_data vertical3x4_filter_data
+#define output_target vertical3x4_output_target
+#define softfilter_set_output_target vertical3x4_set_output_target
 #endif
 
 struct softfilter_thread_data
@@ -35,6 +38,7 @@ struct softfilter_thread_data
    unsigned colfmt;
    unsigned width;
    unsigned height;
+   unsigned border;
    int first;
    int last;
 };
@@ -46,6 +50,9 @@ struct filter_data
    unsigned in_fmt;
 };
 
+/* Driver surface to render into, see softfilter_target.h */
+static struct softfilter_output_target *output_target;
+
 static unsigned vertical3x4_generic_input_fmts(void)
 {
    return SOFTFILTER_FMT_XRGB8888 | SOFTFILTER_FMT_RGB565;
@@ -75,10 +82,12 @@ static void *vertical3x4_generic_create(const struct softfilter_config *config,
    if (!filt) {
       return NULL;
    }
-   /* Apparently the code is not thread-safe,
-    * so force single threaded operation... */
-   filt->workers = (struct softfilter_thread_data*)calloc(1, sizeof(struct softfilter_thread_data));
-   filt->threads = 1;
+   /* Rows are independent, each thread copies a band of rows */
+   if (!threads) {
+      threads = 1;
+   }
+   filt->workers = (struct softfilter_thread_data*)calloc(threads, sizeof(struct softfilter_thread_data));
+   filt->threads = threads;
    filt->in_fmt  = in_fmt;
    if (!filt->workers) {
       free(filt);
@@ -108,33 +117,26 @@ static void vertical3x4_generic_destroy(void *data)
 static void vertical3x4_work_cb(void *data, void *thread_data)
 {
    struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
-   const void* src = thr->in_data;
-   void* dst = thr->out_data;
+   const uint8_t* src = (const uint8_t*)thr->in_data;
+   uint8_t* dst = (uint8_t*)thr->out_data;
    unsigned ip = thr->in_pitch;
    unsigned op = thr->out_pitch;
    unsigned ch = thr->height;
-   unsigned bh = (((ch << 4) / 9) - ch) >> 1;
+   unsigned bs = op * thr->border;
+   unsigned rs = thr->width * ((thr->colfmt == SOFTFILTER_FMT_XRGB8888) ? 4 : 2);
 
+   /* top / bottom borders are cleared by the first / last band */
+   if (thr->first && bs) {
+      memset(dst - bs, 0, bs);
+   }
    if (ip == op) {
-      unsigned cs = op * ch;
-      if (bh) {
-         unsigned bs = op * bh;
-         memset(dst, 0, bs); dst += bs;
-         memcpy(dst, src, cs); dst += cs;
-         memset(dst, 0, bs);
-      } else {
-         memcpy(dst, src, cs);
-      }
+      memcpy(dst, src, op * ch); dst += op * ch;
    } else {
       unsigned i;
-      if (bh) {
-         unsigned bs = op * bh;
-         memset(dst, 0, bs); dst += bs;
-         for (i=ch; i>0; i--, src += ip, dst += op) memcpy(dst, src, ip);
-         memset(dst, 0, bs);
-      } else {
-         for (i=ch; i>0; i--, src += ip, dst += op) memcpy(dst, src, ip);
-      }
+      for (i=ch; i>0; i--, src += ip, dst += op) memcpy(dst, src, rs);
+   }
+   if (thr->last && bs) {
+      memset(dst, 0, bs);
    }
 }
 
@@ -143,23 +145,45 @@ static void vertical3x4_generic_packets(void *data,
       void *output, size_t output_stride,
       const void *input, unsigned width, unsigned height, size_t input_stride)
 {
-   /* We are guaranteed single threaded operation
-    * (filt->threads = 1) so we don't need to loop
-    * over threads and can cull some code. This only
-    * makes the tiniest performance difference, but
-    * every little helps when running on an o3DS... */
    struct filter_data *filt = (struct filter_data*)data;
-   struct softfilter_thread_data *thr = (struct softfilter_thread_data*)&filt->workers[0];
-
-   thr->out_data = (uint8_t*)output;
-   thr->in_data = (const uint8_t*)input;
-   thr->out_pitch = output_stride;
-   thr->in_pitch = input_stride;
-   thr->width = width;
-   thr->height = height;
+   unsigned bh = (((height << 4) / 9) - height) >> 1;
+   unsigned i;
+
+   /* Render into the driver's surface when it has exactly the output size */
+   if (output_target) {
+      unsigned out_width, out_height;
+      vertical3x4_generic_output(data, &out_width, &out_height, width, height);
+      output_target->replaced = NULL;
+      if (output_target->data && (output_target->width == out_width) &&
+            (output_target->height == out_height)) {
+         output_target->replaced = output;
+         output_target->written = output_target->data;
+         output_target->written_pitch = output_target->pitch;
+         output = output_target->data;
+         output_stride = output_target->pitch;
+      }
+   }
 
-   packets[0].work = vertical3x4_work_cb;
-   packets[0].thread_data = thr;
+   /* Split into bands of rows, remainder of odd heights is spread over the bands */
+   for (i = 0; i < filt->threads; i++) {
+      struct softfilter_thread_data *thr = (struct softfilter_thread_data*)&filt->workers[i];
+      unsigned y_start = (height * i) / filt->threads;
+      unsigned y_end   = (height * (i + 1)) / filt->threads;
+
+      thr->out_data = (uint8_t*)output + (bh + y_start) * output_stride;
+      thr->in_data = (const uint8_t*)input + y_start * input_stride;
+      thr->out_pitch = output_stride;
+      thr->in_pitch = input_stride;
+      thr->colfmt = filt->in_fmt;
+      thr->width = width;
+      thr->height = y_end - y_start;
+      thr->border = bh;
+      thr->first = (i == 0);
+      thr->last = (i == filt->threads - 1);
+
+      packets[i].work = vertical3x4_work_cb;
+      packets[i].thread_data = thr;
+   }
 }
 
 static const struct softfilter_implementation vertical3x4_generic = {
@@ -185,8 +209,15 @@ const struct softfilter_implementation *softfilter_get_implementation(
    return &vertical3x4_generic;
 }
 
+void softfilter_set_output_target(struct softfilter_output_target *target)
+{
+   output_target = target;
+}
+
 #ifdef RARCH_INTERNAL
 #undef softfilter_get_implementation
 #undef softfilter_thread_data
 #undef filter_data
+#undef output_target
+#undef softfilter_set_output_target
 #endif
@@ -25,6 +25,9 @@
 #include "../../config.def.h"
 #include "../../tasks/tasks_internal.h"
 #include "../../verbosity.h"
+#if defined(MIYOOMINI)
+#include "../../miyoomini.h"
+#endif
 
 #include <unistd.h>
 #include <fcntl.h>
@@ -253,6 +256,11 @@ static void sdl_miyoomini_joypad_poll(void) {
    miyoomini_joypad_t *joypad = (miyoomini_joypad_t*)&miyoomini_joypad;
    SDL_Event event;
 
+#if defined(MIYOOMINI)
+   /* External UI owns the input while the game is deep paused */
+   if (miyoo_deep_paused()) return;
+#endif
+
 #if defined(SDL_MIYOOMINI_HAS_MENU_TOGGLE)
    /* Note: The menu toggle key is an awkward special
     * case - the press/release events happen almost
@@ -9,12 +9,106 @@
 #include "runloop.h"
 #include "string/stdstring.h"
 #include "verbosity.h"
+#include <errno.h>
 #include <fcntl.h>
 #include <linux/fb.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <spawn.h>
+#include <string.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
 #include <unistd.h>
 
-static int res_x = 0, res_y = 0;
+#define THREAD_POLICY_FILE_PATH                                                \
+  "/mnt/SDCARD/.tmp_update/config/RetroArch/.threadPolicy"
+#define THREAD_POLICY_BENCH_FRAMES 1200
+#define JITTER_FREE_FILE_PATH                                                  \
+  "/mnt/SDCARD/.tmp_update/config/RetroArch/.jitterFree"
+#define JITTER_FREE_STACK_SIZE (64 * 1024)
+#define SPAWN_QUEUE_SIZE 8
+#define SPAWN_ARGS_MAX 8
+#define SPAWN_ARGS_LEN 512
+#define DEEP_PAUSE_CLIENTS_MAX 4
+
+extern char **environ;
+
+/* Thread placement policies
+ * NONE     : both cores, SCHED_OTHER (kernel default)
+ * SPLIT    : emulation on CPU0, flip/audio/presenter on CPU1, SCHED_OTHER
+ * SPLIT_RT : SPLIT + SCHED_FIFO for flip/audio */
+enum miyoo_thread_policy {
+  MIYOO_POLICY_NONE = 0,
+  MIYOO_POLICY_SPLIT,
+  MIYOO_POLICY_SPLIT_RT,
+  MIYOO_POLICY_LAST
+};
+
+static const char *const thread_policy_names[MIYOO_POLICY_LAST] = {
+    "none", "split", "split_rt"};
+
+static struct {
+  pthread_mutex_t lock;
+  bool loaded;
+  bool enabled;
+  bool bench;
+  enum miyoo_thread_policy policy;
+  bool registered[MIYOO_THREAD_LAST];
+  pthread_t threads[MIYOO_THREAD_LAST];
+  /* benchmark state, frame intervals in usec */
+  uint64_t last_frame;
+  uint32_t count;
+  double mean;
+  double m2;
+  double result[MIYOO_POLICY_LAST];
+} thread_policy = {PTHREAD_MUTEX_INITIALIZER};
+
+static struct {
+  bool loaded;
+  bool enabled;
+  uint64_t last_time;
+  long last_majflt;
+  long last_minflt;
+} jitter_free;
+
+struct spawn_job {
+  char args[SPAWN_ARGS_LEN];
+  int argc;
+  miyoo_spawn_cb_t cb;
+  void *userdata;
+};
+
+static struct {
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  bool running;
+  uint32_t head;
+  uint32_t tail;
+  struct spawn_job jobs[SPAWN_QUEUE_SIZE];
+} spawn_service = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER};
+
+static struct {
+  pthread_mutex_t lock;
+  volatile bool paused;
+  struct {
+    miyoo_deep_pause_cb_t cb;
+    void *userdata;
+  } clients[DEEP_PAUSE_CLIENTS_MAX];
+} deep_pause = {PTHREAD_MUTEX_INITIALIZER};
+
+static struct {
+  pthread_mutex_t lock;
+  bool running;
+  int pipe[2];
+  volatile uint32_t seq;
+  miyoo_resume_cb_t cb;
+  void *userdata;
+} suspend_service = {PTHREAD_MUTEX_INITIALIZER, false, {-1, -1}};
 
 /**
  * @brief Displays an on-screen notification of the current scaling option.
@@ -30,25 +124,25 @@ static int res_x = 0, res_y = 0;
 static void show_miyoo_fullscreen_notification(settings_t *settings) {
   char msg[PATH_MAX_LENGTH];
   struct retro_message_ext msg_obj = {0};
+  int res_x = 0, res_y = 0;
 
   msg[0] = '\0';
 
-  if (res_x == 0 || res_y == 0) {
-    const char *fb_device = "/dev/fb0";
-    int fb = open(fb_device, O_RDWR);
+  /* Not cached, the resolution can be switched while running */
+  const char *fb_device = "/dev/fb0";
+  int fb = open(fb_device, O_RDWR);
 
-    if (fb == -1) {
-      RARCH_ERR("Error opening framebuffer device");
+  if (fb == -1) {
+    RARCH_ERR("Error opening framebuffer device");
+  } else {
+    struct fb_var_screeninfo vinfo;
+    if (ioctl(fb, FBIOGET_VSCREENINFO, &vinfo)) {
+      RARCH_ERR("Error reading variable information");
     } else {
-      struct fb_var_screeninfo vinfo;
-      if (ioctl(fb, FBIOGET_VSCREENINFO, &vinfo)) {
-        RARCH_ERR("Error reading variable information");
-        close(fb);
-      } else {
-        res_x = vinfo.xres;
-        res_y = vinfo.yres;
-      }
+      res_x = vinfo.xres;
+      res_y = vinfo.yres;
     }
+    close(fb);
   }
 
   snprintf(msg, sizeof(msg), "Integer scaling: %s (%s) - %dx%d",
@@ -207,4 +301,603 @@ void miyoo_event_fullscreen_impl(settings_t *settings) {
   write_core_override_aspect_scale(settings);
 }
 
+/**
+ * @brief Reads the thread placement policy from THREAD_POLICY_FILE_PATH.
+ *
+ * The file contains one of "none", "split", "split_rt" or "bench".
+ * An empty file selects "split_rt". When the file does not exist, thread
+ * placement is left untouched.
+ */
+static void thread_policy_load(void) {
+  char buf[16] = {0};
+  FILE *fp;
+
+  thread_policy.loaded = true;
+  if (!(fp = fopen(THREAD_POLICY_FILE_PATH, "r")))
+    return;
+  if (fgets(buf, sizeof(buf), fp))
+    buf[strcspn(buf, "\r\n ")] = 0;
+  fclose(fp);
+
+  thread_policy.enabled = true;
+  thread_policy.policy = MIYOO_POLICY_SPLIT_RT;
+  if (string_is_equal(buf, "bench")) {
+    thread_policy.bench = true;
+    thread_policy.policy = MIYOO_POLICY_NONE;
+  } else {
+    for (int i = 0; i < MIYOO_POLICY_LAST; i++)
+      if (string_is_equal(buf, thread_policy_names[i]))
+        thread_policy.policy = (enum miyoo_thread_policy)i;
+  }
+  RARCH_LOG("[CPU]: Thread policy: %s\n",
+            thread_policy.bench ? "bench"
+                                : thread_policy_names[thread_policy.policy]);
+}
+
+/**
+ * @brief Writes the policy chosen by the benchmark back to
+ * THREAD_POLICY_FILE_PATH, so later launches use it without re-running
+ * the benchmark.
+ *
+ * @param policy Chosen policy
+ */
+static void thread_policy_save(enum miyoo_thread_policy policy) {
+  FILE *fp;
+
+  if (!(fp = fopen(THREAD_POLICY_FILE_PATH, "w"))) {
+    RARCH_WARN("[CPU]: Failed to save thread policy\n");
+    return;
+  }
+  fprintf(fp, "%s\n", thread_policy_names[policy]);
+  fclose(fp);
+}
+
+/**
+ * @brief Applies the current policy to a registered thread.
+ *
+ * @param role Thread role
+ */
+static void thread_policy_apply(enum miyoo_thread_role role) {
+  struct sched_param param = {0};
+  int sched = SCHED_OTHER;
+  cpu_set_t cpus;
+
+  CPU_ZERO(&cpus);
+  switch (thread_policy.policy) {
+  case MIYOO_POLICY_SPLIT:
+  case MIYOO_POLICY_SPLIT_RT:
+    CPU_SET(role == MIYOO_THREAD_EMU ? 0 : 1, &cpus);
+    /* presenter scales for milliseconds, it must not delay flip/audio */
+    if (thread_policy.policy == MIYOO_POLICY_SPLIT_RT &&
+        (role == MIYOO_THREAD_FLIP || role == MIYOO_THREAD_AUDIO)) {
+      /* flip must not be delayed by audio refill */
+      sched = SCHED_FIFO;
+      param.sched_priority = (role == MIYOO_THREAD_FLIP) ? 2 : 1;
+    }
+    break;
+  default:
+    CPU_SET(0, &cpus);
+    CPU_SET(1, &cpus);
+    break;
+  }
+
+  if (pthread_setaffinity_np(thread_policy.threads[role], sizeof(cpus),
+                             &cpus))
+    RARCH_WARN("[CPU]: Failed to set affinity of thread %d\n", role);
+  if (pthread_setschedparam(thread_policy.threads[role], sched, &param))
+    RARCH_WARN("[CPU]: Failed to set scheduler of thread %d\n", role);
+}
+
+/**
+ * @brief Registers a thread and applies the configured placement policy.
+ *
+ * Called for the emulation, flip and presenter threads at GFX init, and
+ * from the audio callback thread at audio init.
+ *
+ * @param role Thread role
+ * @param thread Thread handle
+ */
+void miyoo_thread_policy_register(enum miyoo_thread_role role,
+                                  pthread_t thread) {
+  pthread_mutex_lock(&thread_policy.lock);
+  if (!thread_policy.loaded)
+    thread_policy_load();
+  if (thread_policy.enabled) {
+    thread_policy.threads[role] = thread;
+    thread_policy.registered[role] = true;
+    thread_policy_apply(role);
+  }
+  pthread_mutex_unlock(&thread_policy.lock);
+}
+
+/**
+ * @brief Unregisters a thread, must be called before the thread exits.
+ *
+ * @param role Thread role
+ */
+void miyoo_thread_policy_unregister(enum miyoo_thread_role role) {
+  pthread_mutex_lock(&thread_policy.lock);
+  thread_policy.registered[role] = false;
+  pthread_mutex_unlock(&thread_policy.lock);
+}
+
+/**
+ * @brief Benchmark mode, called for every presented frame.
+ *
+ * Measures the frame time variance of each policy over
+ * THREAD_POLICY_BENCH_FRAMES frames, then switches to the next one.
+ * After all policies are measured, the one with the lowest variance
+ * is kept and saved in place of "bench".
+ */
+void miyoo_thread_policy_frame(void) {
+  struct timespec ts;
+  uint64_t now, prev;
+  double delta, interval;
+
+  if (!thread_policy.bench)
+    return;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  now = (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+  prev = thread_policy.last_frame;
+  thread_policy.last_frame = now;
+  interval = (double)(now - prev);
+  /* skip the first frame and stalls (menu, loading) */
+  if (!prev || interval > 100000.0)
+    return;
+
+  /* Welford's online variance */
+  thread_policy.count++;
+  delta = interval - thread_policy.mean;
+  thread_policy.mean += delta / thread_policy.count;
+  thread_policy.m2 += delta * (interval - thread_policy.mean);
+  if (thread_policy.count < THREAD_POLICY_BENCH_FRAMES)
+    return;
+
+  pthread_mutex_lock(&thread_policy.lock);
+  thread_policy.result[thread_policy.policy] =
+      thread_policy.m2 / (thread_policy.count - 1);
+  RARCH_LOG("[CPU]: Thread policy %s: frame time %.3f ms, stddev %.3f ms\n",
+            thread_policy_names[thread_policy.policy],
+            thread_policy.mean / 1000.0,
+            sqrt(thread_policy.result[thread_policy.policy]) / 1000.0);
+
+  if (thread_policy.policy + 1 < MIYOO_POLICY_LAST) {
+    thread_policy.policy++;
+  } else {
+    enum miyoo_thread_policy best = MIYOO_POLICY_NONE;
+    for (int i = 1; i < MIYOO_POLICY_LAST; i++)
+      if (thread_policy.result[i] < thread_policy.result[best])
+        best = (enum miyoo_thread_policy)i;
+    thread_policy.policy = best;
+    thread_policy.bench = false;
+    RARCH_LOG("[CPU]: Thread policy bench done, using %s\n",
+              thread_policy_names[best]);
+    thread_policy_save(best);
+  }
+  for (int i = 0; i < MIYOO_THREAD_LAST; i++)
+    if (thread_policy.registered[i])
+      thread_policy_apply((enum miyoo_thread_role)i);
+  thread_policy.count = 0;
+  thread_policy.mean = thread_policy.m2 = 0.0;
+  pthread_mutex_unlock(&thread_policy.lock);
+}
+
+/**
+ * @brief Enables the jitter-free runtime mode if JITTER_FREE_FILE_PATH
+ * exists.
+ *
+ * Locks all current and future mappings with mlockall() and prefaults the
+ * stack of the calling (emulation) thread, so that no page faults occur
+ * in the middle of a frame. Call before GFX_Init.
+ *
+ * @return true Jitter-free mode is enabled
+ */
+bool miyoo_jitter_free_init(void) {
+  if (jitter_free.loaded)
+    return jitter_free.enabled;
+  jitter_free.loaded = true;
+
+  if (access(JITTER_FREE_FILE_PATH, F_OK))
+    return false;
+  jitter_free.enabled = true;
+
+  if (mlockall(MCL_CURRENT | MCL_FUTURE))
+    RARCH_WARN("[CPU]: mlockall failed, page faults may still occur\n");
+  else
+    RARCH_LOG("[CPU]: Jitter-free mode, all memory locked\n");
+
+  /* touch the stack in advance */
+  {
+    volatile uint8_t stack[JITTER_FREE_STACK_SIZE];
+    for (size_t i = 0; i < sizeof(stack); i += 4096)
+      stack[i] = 0;
+  }
+  return true;
+}
+
+/**
+ * @brief Touches every page of a buffer when jitter-free mode is enabled,
+ * so that the first write during gameplay does not fault.
+ *
+ * @param buf Buffer
+ * @param size Buffer size in bytes
+ */
+void miyoo_prefault(void *buf, size_t size) {
+  volatile uint8_t *p = (volatile uint8_t *)buf;
+
+  if (!jitter_free.enabled || !buf)
+    return;
+  for (size_t i = 0; i < size; i += 4096)
+    p[i] = p[i];
+  if (size)
+    p[size - 1] = p[size - 1];
+}
+
+/**
+ * @brief Logs major/minor page faults per second when jitter-free mode is
+ * enabled. Called for every presented frame, only logs when faults occurred.
+ */
+void miyoo_fault_stats_frame(void) {
+  struct timespec ts;
+  struct rusage usage;
+  uint64_t now;
+  double elapsed;
+
+  if (!jitter_free.enabled)
+    return;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  now = (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+  if (now - jitter_free.last_time < 1000000)
+    return;
+
+  getrusage(RUSAGE_SELF, &usage);
+  /* long is 32-bit here, counts * 1000000 would overflow */
+  elapsed = (double)(now - jitter_free.last_time) / 1000000.0;
+  if (jitter_free.last_time &&
+      (usage.ru_majflt != jitter_free.last_majflt ||
+       usage.ru_minflt != jitter_free.last_minflt))
+    RARCH_LOG("[CPU]: Page faults/s: major %.0f, minor %.0f\n",
+              (double)(usage.ru_majflt - jitter_free.last_majflt) / elapsed,
+              (double)(usage.ru_minflt - jitter_free.last_minflt) / elapsed);
+  jitter_free.last_time = now;
+  jitter_free.last_majflt = usage.ru_majflt;
+  jitter_free.last_minflt = usage.ru_minflt;
+}
+
+/**
+ * @brief Runs a process with posix_spawnp and waits for it.
+ *
+ * posix_spawn does not duplicate the address space like fork() in system().
+ * No shell is involved, except for ".sh" scripts which are run by /bin/sh
+ * like system() did, as they may lack a #! line.
+ *
+ * @param argv Program and arguments, NULL terminated
+ * @return int Exit status, -1 on failure
+ */
+static int spawn_run(char *const argv[]) {
+  char *sh_argv[SPAWN_ARGS_MAX + 2];
+  size_t len = strlen(argv[0]);
+  pid_t pid;
+  int status = 0;
+
+  if (len > 3 && string_is_equal(argv[0] + len - 3, ".sh")) {
+    int i;
+    sh_argv[0] = (char *)"/bin/sh";
+    for (i = 0; argv[i] && i < SPAWN_ARGS_MAX; i++)
+      sh_argv[i + 1] = argv[i];
+    sh_argv[i + 1] = NULL;
+    if (argv[i])
+      RARCH_WARN("[SPAWN]: Arguments of %s truncated to %d\n", argv[0], i);
+    argv = sh_argv;
+  }
+
+  if (posix_spawnp(&pid, argv[0], NULL, NULL, argv, environ)) {
+    RARCH_WARN("[SPAWN]: Failed to run %s\n", argv[0]);
+    return -1;
+  }
+  while (waitpid(pid, &status, 0) < 0) {
+    /* ECHILD when SIGCHLD is ignored, status is unknown */
+    if (errno != EINTR)
+      return 0;
+  }
+  return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+/**
+ * @brief Spawn service thread, runs queued jobs in order.
+ */
+static void *spawn_thread(void *arg) {
+  struct spawn_job job;
+  char *argv[SPAWN_ARGS_MAX + 1];
+
+  pthread_mutex_lock(&spawn_service.lock);
+  while (1) {
+    while (spawn_service.head == spawn_service.tail)
+      pthread_cond_wait(&spawn_service.cond, &spawn_service.lock);
+    job = spawn_service.jobs[spawn_service.tail % SPAWN_QUEUE_SIZE];
+    spawn_service.tail++;
+    pthread_mutex_unlock(&spawn_service.lock);
+
+    /* args are packed NUL separated */
+    char *arg = job.args;
+    for (int i = 0; i < job.argc; i++) {
+      argv[i] = arg;
+      arg += strlen(arg) + 1;
+    }
+    argv[job.argc] = NULL;
+    int status = spawn_run(argv);
+    if (job.cb)
+      job.cb(status, job.userdata);
+
+    pthread_mutex_lock(&spawn_service.lock);
+  }
+  return NULL;
+}
+
+/**
+ * @brief Queues a helper process to be run asynchronously off the calling
+ * thread. Jobs are run one by one in order of submission.
+ *
+ * @param argv Program and arguments, NULL terminated
+ * @param cb Completion callback, called on the spawn thread (may be NULL)
+ * @param userdata Passed to cb
+ * @return true Job is queued
+ */
+bool miyoo_spawn(const char *const argv[], miyoo_spawn_cb_t cb,
+                 void *userdata) {
+  struct spawn_job *job;
+  size_t len = 0;
+  int i;
+
+  pthread_mutex_lock(&spawn_service.lock);
+  if (!spawn_service.running) {
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, spawn_thread, NULL)) {
+      pthread_mutex_unlock(&spawn_service.lock);
+      return false;
+    }
+    pthread_detach(thread);
+    spawn_service.running = true;
+  }
+  if (spawn_service.head - spawn_service.tail >= SPAWN_QUEUE_SIZE) {
+    pthread_mutex_unlock(&spawn_service.lock);
+    RARCH_WARN("[SPAWN]: Queue full, %s dropped\n", argv[0]);
+    return false;
+  }
+
+  job = &spawn_service.jobs[spawn_service.head % SPAWN_QUEUE_SIZE];
+  for (i = 0; argv[i] && i < SPAWN_ARGS_MAX; i++) {
+    size_t n = strlen(argv[i]) + 1;
+    if (len + n > sizeof(job->args))
+      break;
+    memcpy(job->args + len, argv[i], n);
+    len += n;
+  }
+  if (argv[i])
+    RARCH_WARN("[SPAWN]: Arguments of %s truncated to %d\n", argv[0], i);
+  job->argc = i;
+  job->cb = cb;
+  job->userdata = userdata;
+  spawn_service.head++;
+  pthread_cond_signal(&spawn_service.cond);
+  pthread_mutex_unlock(&spawn_service.lock);
+  return true;
+}
+
+/**
+ * @brief Runs a helper process on the calling thread and waits for it,
+ * for jobs whose result is needed right away.
+ *
+ * @param argv Program and arguments, NULL terminated
+ * @return int Exit status, -1 on failure
+ */
+int miyoo_spawn_wait(const char *const argv[]) {
+  return spawn_run((char *const *)argv);
+}
+
+/**
+ * @brief Registers a driver callback for deep pause entry and exit.
+ *
+ * @param cb Callback, called on the thread issuing the pause command
+ * @param userdata Passed to the callback
+ * @return true on success, false when all slots are used
+ */
+bool miyoo_deep_pause_register(miyoo_deep_pause_cb_t cb, void *userdata) {
+  bool ret = false;
+
+  pthread_mutex_lock(&deep_pause.lock);
+  for (int i = 0; i < DEEP_PAUSE_CLIENTS_MAX; i++) {
+    if (!deep_pause.clients[i].cb) {
+      deep_pause.clients[i].cb = cb;
+      deep_pause.clients[i].userdata = userdata;
+      ret = true;
+      break;
+    }
+  }
+  pthread_mutex_unlock(&deep_pause.lock);
+  return ret;
+}
+
+/**
+ * @brief Unregisters a deep pause callback.
+ *
+ * @param cb Callback passed to miyoo_deep_pause_register()
+ */
+void miyoo_deep_pause_unregister(miyoo_deep_pause_cb_t cb) {
+  pthread_mutex_lock(&deep_pause.lock);
+  for (int i = 0; i < DEEP_PAUSE_CLIENTS_MAX; i++)
+    if (deep_pause.clients[i].cb == cb)
+      deep_pause.clients[i].cb = NULL;
+  pthread_mutex_unlock(&deep_pause.lock);
+}
+
+/**
+ * @brief Enters or leaves the low-power deep pause.
+ *
+ * Called by the PAUSE / UNPAUSE network commands, which the external UI
+ * uses to suspend the game for long periods. Registered drivers drop to
+ * minimum clock, stop audio output and input polling, and restore them
+ * on exit before the next frame runs.
+ *
+ * @param paused true to enter, false to leave
+ */
+void miyoo_deep_pause(bool paused) {
+  pthread_mutex_lock(&deep_pause.lock);
+  if (deep_pause.paused != paused) {
+    deep_pause.paused = paused;
+    RARCH_LOG("[CPU]: Deep pause %s\n", paused ? "entered" : "left");
+    for (int i = 0; i < DEEP_PAUSE_CLIENTS_MAX; i++)
+      if (deep_pause.clients[i].cb)
+        deep_pause.clients[i].cb(paused, deep_pause.clients[i].userdata);
+  }
+  pthread_mutex_unlock(&deep_pause.lock);
+}
+
+/**
+ * @brief Returns whether the deep pause is active.
+ */
+bool miyoo_deep_paused(void) { return deep_pause.paused; }
+
+/**
+ * @brief SIGCONT handler, only forwards the signal to the suspend service
+ * thread. Nothing else is async-signal-safe here.
+ */
+static void suspend_sighandler(int sig) {
+  int saved_errno = errno;
+  uint8_t b = (uint8_t)sig;
+  /* non-blocking, dropped when full as a resume is already pending */
+  ssize_t ret = write(suspend_service.pipe[1], &b, 1);
+
+  (void)ret;
+  errno = saved_errno;
+}
+
+/**
+ * @brief Suspend service thread, handles the signals written to the pipe
+ * by suspend_sighandler() outside of signal context.
+ */
+static void *suspend_thread(void *arg) {
+  uint8_t sig;
+
+  while (1) {
+    ssize_t n = read(suspend_service.pipe[0], &sig, 1);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      break;
+    if (sig != SIGCONT)
+      continue;
+
+    pthread_mutex_lock(&suspend_service.lock);
+    if (suspend_service.cb)
+      suspend_service.cb(suspend_service.userdata);
+    /* picked up by the drivers on their own thread */
+    suspend_service.seq++;
+    pthread_mutex_unlock(&suspend_service.lock);
+    RARCH_LOG("[CPU]: Resumed from suspend\n");
+  }
+  return NULL;
+}
+
+/**
+ * @brief Registers the resume callback and starts the suspend service.
+ *
+ * The launcher suspends RetroArch with SIGSTOP (which cannot be caught) and
+ * resumes it with SIGCONT. The handler only writes to a pipe; the callback
+ * runs on the service thread, so it may block on file I/O. Work which must
+ * happen on a driver's own thread is done when miyoo_resume_seq() changes.
+ *
+ * @param cb Callback, called on the suspend service thread
+ * @param userdata Passed to the callback
+ * @return true on success
+ */
+bool miyoo_resume_register(miyoo_resume_cb_t cb, void *userdata) {
+  pthread_mutex_lock(&suspend_service.lock);
+  if (!suspend_service.running) {
+    struct sigaction sa;
+    pthread_t thread;
+
+    if (pipe(suspend_service.pipe)) {
+      pthread_mutex_unlock(&suspend_service.lock);
+      return false;
+    }
+    fcntl(suspend_service.pipe[0], F_SETFD, FD_CLOEXEC);
+    fcntl(suspend_service.pipe[1], F_SETFD, FD_CLOEXEC);
+    fcntl(suspend_service.pipe[1], F_SETFL, O_NONBLOCK);
+    if (pthread_create(&thread, NULL, suspend_thread, NULL)) {
+      close(suspend_service.pipe[0]);
+      close(suspend_service.pipe[1]);
+      suspend_service.pipe[0] = suspend_service.pipe[1] = -1;
+      pthread_mutex_unlock(&suspend_service.lock);
+      return false;
+    }
+    pthread_detach(thread);
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = suspend_sighandler;
+    sa.sa_flags = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGCONT, &sa, NULL);
+    suspend_service.running = true;
+  }
+  suspend_service.cb = cb;
+  suspend_service.userdata = userdata;
+  pthread_mutex_unlock(&suspend_service.lock);
+  return true;
+}
+
+/**
+ * @brief Unregisters the resume callback. The service keeps running, resumes
+ * are still counted by miyoo_resume_seq().
+ */
+void miyoo_resume_unregister(void) {
+  pthread_mutex_lock(&suspend_service.lock);
+  suspend_service.cb = NULL;
+  suspend_service.userdata = NULL;
+  pthread_mutex_unlock(&suspend_service.lock);
+}
+
+/**
+ * @brief Returns the resume counter, incremented after every SIGCONT once
+ * the resume callback has run.
+ */
+uint32_t miyoo_resume_seq(void) { return suspend_service.seq; }
+
+static bool video_skip;
+
+/**
+ * @brief Sets the video driver's prediction that the frame of the next core
+ * run is dropped (fast forward). Only read and written on the main thread.
+ *
+ * @param skip true to report video disabled to the core
+ */
+void miyoo_video_skip_set(bool skip) { video_skip = skip; }
+
+/**
+ * @brief Returns whether RETRO_ENVIRONMENT_GET_AUDIO_VIDEO_ENABLE reports
+ * video disabled. Unlike clearing VIDEO_FLAG_ACTIVE, the frontend still
+ * calls the driver's frame(), which drops the prediction.
+ */
+bool miyoo_video_skip(void) { return video_skip; }
+
+static bool thumbnail_capture;
+
+/**
+ * @brief Marks the next viewport capture as a savestate thumbnail, set by
+ * the screenshot task around its viewport_info call.
+ *
+ * @param thumbnail true while a savestate thumbnail is being captured
+ */
+void miyoo_thumbnail_capture_set(bool thumbnail) {
+  thumbnail_capture = thumbnail;
+}
+
+/**
+ * @brief Returns whether the video driver should report (and then capture)
+ * the viewport at thumbnail size.
+ */
+bool miyoo_thumbnail_capture(void) { return thumbnail_capture; }
+
 #endif
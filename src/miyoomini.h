@@ -3,7 +3,50 @@
 #if defined(MIYOOMINI)
 
 #include "configuration.h"
+#include <pthread.h>
+
+enum miyoo_thread_role {
+  MIYOO_THREAD_EMU = 0,
+  MIYOO_THREAD_FLIP,
+  MIYOO_THREAD_AUDIO,
+  MIYOO_THREAD_PRESENT,
+  MIYOO_THREAD_LAST
+};
 
 void miyoo_event_fullscreen_impl(settings_t *settings);
 
+void miyoo_thread_policy_register(enum miyoo_thread_role role,
+                                  pthread_t thread);
+void miyoo_thread_policy_unregister(enum miyoo_thread_role role);
+void miyoo_thread_policy_frame(void);
+
+bool miyoo_jitter_free_init(void);
+void miyoo_prefault(void *buf, size_t size);
+void miyoo_fault_stats_frame(void);
+
+typedef void (*miyoo_spawn_cb_t)(int status, void *userdata);
+
+bool miyoo_spawn(const char *const argv[], miyoo_spawn_cb_t cb,
+                 void *userdata);
+int miyoo_spawn_wait(const char *const argv[]);
+
+typedef void (*miyoo_deep_pause_cb_t)(bool paused, void *userdata);
+
+bool miyoo_deep_pause_register(miyoo_deep_pause_cb_t cb, void *userdata);
+void miyoo_deep_pause_unregister(miyoo_deep_pause_cb_t cb);
+void miyoo_deep_pause(bool paused);
+bool miyoo_deep_paused(void);
+
+typedef void (*miyoo_resume_cb_t)(void *userdata);
+
+bool miyoo_resume_register(miyoo_resume_cb_t cb, void *userdata);
+void miyoo_resume_unregister(void);
+uint32_t miyoo_resume_seq(void);
+
+void miyoo_video_skip_set(bool skip);
+bool miyoo_video_skip(void);
+
+void miyoo_thumbnail_capture_set(bool thumbnail);
+bool miyoo_thumbnail_capture(void);
+
 #endif